@@ -14,29 +14,84 @@
 
 from gi.repository import Atspi
 
+import sys as _sys
+from importlib import import_module as _import_module
+
 from pyatspi.registry import *
 Registry = Registry()
 
-from pyatspi.application import *
 from pyatspi.constants import *
-from pyatspi.editabletext import *
 from pyatspi.role import *
 from pyatspi.state import *
-from pyatspi.text import *
-from pyatspi.document import *
 from pyatspi.utils import *
-from pyatspi.action import *
-from pyatspi.component import *
-from pyatspi.collection import *
-from pyatspi.hypertext import *
-from pyatspi.image import *
-from pyatspi.selection import *
-from pyatspi.table import *
-from pyatspi.tablecell import *
-from pyatspi.value import *
 from pyatspi.appevent import *
 from pyatspi.interface import *
 
+# The modules below are only imported when one of their names is first
+# used. The names are listed here so that they can be resolved without
+# importing every module; keep them in step with the modules' __all__.
+_lazyModules = {
+        "pyatspi.action": ("Action",),
+        "pyatspi.application": ("Application",),
+        "pyatspi.collection": ("Collection", "SortOrder", "MatchType", "TreeTraversalType"),
+        "pyatspi.component": ("CoordType", "XY_SCREEN", "XY_WINDOW", "ComponentLayer",
+                              "Component", "getExtentsBatch",
+                              "LAYER_BACKGROUND", "LAYER_CANVAS", "LAYER_INVALID",
+                              "LAYER_LAST_DEFINED", "LAYER_MDI", "LAYER_OVERLAY",
+                              "LAYER_POPUP", "LAYER_WIDGET", "LAYER_WINDOW"),
+        "pyatspi.document": ("Document",),
+        "pyatspi.editabletext": ("EditableText",),
+        "pyatspi.eventtrace": ("EventTraceWriter", "EventTraceReader", "TraceEvent"),
+        "pyatspi.focus": ("FocusTracker",),
+        "pyatspi.hypertext": ("Hypertext",),
+        "pyatspi.image": ("Image",),
+        "pyatspi.keylog": ("KeyRecorder", "KeyLogReader", "replayKeyLog"),
+        "pyatspi.selection": ("Selection",),
+        "pyatspi.spatialindex": ("SpatialIndex", "computeVisibleRegions"),
+        "pyatspi.table": ("Table", "TableGridCell", "TableViewport"),
+        "pyatspi.tablecell": ("TableCell",),
+        "pyatspi.text": ("Text", "TEXT_BOUNDARY_TYPE", "TEXT_BOUNDARY_CHAR",
+                         "TEXT_BOUNDARY_WORD_START", "TEXT_BOUNDARY_WORD_END",
+                         "TEXT_BOUNDARY_SENTENCE_START", "TEXT_BOUNDARY_SENTENCE_END",
+                         "TEXT_BOUNDARY_LINE_START", "TEXT_BOUNDARY_LINE_END",
+                         "TEXT_CLIP_TYPE", "TEXT_CLIP_NONE", "TEXT_CLIP_MIN",
+                         "TEXT_CLIP_MAX", "TEXT_CLIP_BOTH",
+                         "TEXT_GRANULARITY_CHAR", "TEXT_GRANULARITY_WORD",
+                         "TEXT_GRANULARITY_SENTENCE", "TEXT_GRANULARITY_LINE",
+                         "TEXT_GRANULARITY_PARAGRAPH", "iterTextUnits", "TextSelections"),
+        "pyatspi.value": ("Value",),
+}
+
+_lazyNames = dict((name, module)
+                  for module, names in _lazyModules.items()
+                  for name in names)
+
+def _lazy(name):
+        """
+        Returns one of the names of the lazily imported modules, importing
+        its module on first use. All the names of the module are then
+        added to this module.
+        """
+        try:
+                return globals()[name]
+        except KeyError:
+                pass
+        moduleName = _lazyNames[name]
+        module = _import_module(moduleName)
+        for other in _lazyModules[moduleName]:
+                globals()[other] = getattr(module, other)
+        return globals()[name]
+
+if _sys.version_info >= (3, 7):
+        def __getattr__(name):
+                if name in _lazyNames:
+                        return _lazy(name)
+                raise AttributeError("module %r has no attribute %r" % (__name__, name))
+else:
+        # Module __getattr__ is not supported; import everything.
+        for _name in _lazyNames:
+                _lazy(_name)
+
 def Accessible_getitem(self, i):
         len=self.get_child_count()
         if i < 0:
@@ -107,72 +162,92 @@ def Event_str(self):
                (self.type, self.detail1, self.detail2, self.any_data,
                 self.source, self.host_application)
   
+class _LazyAlias(object):
+        """
+        Stands in for an Atspi method under its pyatspi name. The method is
+        only looked up on first use, then replaces the alias on the class,
+        so that importing pyatspi does not resolve every aliased method.
+        """
+
+        def __init__(self, name, target):
+                self.name = name
+                self.target = target
+
+        def __get__(self, obj, cls):
+                method = getattr(cls, self.target)
+                setattr(cls, self.name, method)
+                return getattr(obj, self.name) if obj is not None else method
+
+def _alias(cls, name, target):
+        setattr(cls, name, _LazyAlias(name, target))
+
 ### Accessible ###
 Accessible = Atspi.Accessible
-Atspi.Accessible.getChildAtIndex = Atspi.Accessible.get_child_at_index
-Atspi.Accessible.getAttributes = Atspi.Accessible.get_attributes_as_array
-Atspi.Accessible.getApplication = Atspi.Accessible.get_application
+_alias(Atspi.Accessible, "getChildAtIndex", "get_child_at_index")
+_alias(Atspi.Accessible, "getAttributes", "get_attributes_as_array")
+_alias(Atspi.Accessible, "getApplication", "get_application")
 Atspi.Accessible.__getitem__ = Accessible_getitem
 Atspi.Accessible.__len__ = Atspi.Accessible.get_child_count
 Atspi.Accessible.__bool__ = lambda x: True
 Atspi.Accessible.__nonzero__ = lambda x: True
 Atspi.Accessible.__str__ = Accessible_str
 Atspi.Accessible.childCount = property(fget=Atspi.Accessible.get_child_count)
-Atspi.Accessible.getChildCount = Atspi.Accessible.get_child_count
-Atspi.Accessible.getIndexInParent = Atspi.Accessible.get_index_in_parent
-Atspi.Accessible.getLocalizedRoleName = Atspi.Accessible.get_localized_role_name
-Atspi.Accessible.getRelationSet = Atspi.Accessible.get_relation_set
-Atspi.Accessible.getRole = Atspi.Accessible.get_role
-Atspi.Accessible.getRoleName = Atspi.Accessible.get_role_name
-Atspi.Accessible.getState = Atspi.Accessible.get_state_set
+_alias(Atspi.Accessible, "getChildCount", "get_child_count")
+_alias(Atspi.Accessible, "getIndexInParent", "get_index_in_parent")
+_alias(Atspi.Accessible, "getLocalizedRoleName", "get_localized_role_name")
+_alias(Atspi.Accessible, "getRelationSet", "get_relation_set")
+_alias(Atspi.Accessible, "getRole", "get_role")
+_alias(Atspi.Accessible, "getRoleName", "get_role_name")
+_alias(Atspi.Accessible, "getState", "get_state_set")
+Atspi.Accessible.getStateMask = lambda x: StateMask.fromStateSet(x.get_state_set())
 del Atspi.Accessible.children
 Atspi.Accessible.description = property(fget=Atspi.Accessible.get_description)
 Atspi.Accessible.objectLocale = property(fget=Atspi.Accessible.get_object_locale)
 Atspi.Accessible.name = property(fget=Atspi.Accessible.get_name)
 Atspi.Accessible.isEqual = lambda a,b: a == b
 Atspi.Accessible.parent = property(fget=Atspi.Accessible.get_parent)
-Atspi.Accessible.setCacheMask = Atspi.Accessible.set_cache_mask
-Atspi.Accessible.clearCache = Atspi.Accessible.clear_cache
+_alias(Atspi.Accessible, "setCacheMask", "set_cache_mask")
+_alias(Atspi.Accessible, "clearCache", "clear_cache")
 
 Atspi.Accessible.id = property(fget=Atspi.Accessible.get_id)
 Atspi.Accessible.toolkitName = property(fget=Atspi.Accessible.get_toolkit_name)
 Atspi.Accessible.toolkitVersion = property(fget=Atspi.Accessible.get_toolkit_version)
 Atspi.Accessible.atspiVersion = property(fget=Atspi.Accessible.get_atspi_version)
 
-Atspi.Accessible.queryAction = lambda x: Action(getInterface(Atspi.Accessible.get_action_iface, x))
-Atspi.Accessible.queryCollection = lambda x: Collection(getInterface(Atspi.Accessible.get_collection_iface, x))
-Atspi.Accessible.queryComponent = lambda x: Component(getInterface(Atspi.Accessible.get_component_iface, x))
-Atspi.Accessible.queryDocument = lambda x: Document(getInterface(Atspi.Accessible.get_document_iface, x))
-Atspi.Accessible.queryEditableText = lambda x: EditableText(getInterface(Atspi.Accessible.get_editable_text_iface, x))
+Atspi.Accessible.queryAction = lambda x: _lazy("Action")(getInterface(Atspi.Accessible.get_action_iface, x))
+Atspi.Accessible.queryCollection = lambda x: _lazy("Collection")(getInterface(Atspi.Accessible.get_collection_iface, x))
+Atspi.Accessible.queryComponent = lambda x: _lazy("Component")(getInterface(Atspi.Accessible.get_component_iface, x))
+Atspi.Accessible.queryDocument = lambda x: _lazy("Document")(getInterface(Atspi.Accessible.get_document_iface, x))
+Atspi.Accessible.queryEditableText = lambda x: _lazy("EditableText")(getInterface(Atspi.Accessible.get_editable_text_iface, x))
 Atspi.Accessible.queryHyperlink = lambda x: getInterface(Atspi.Accessible.get_hyperlink, x)
-Atspi.Accessible.queryHypertext = lambda x: Hypertext(getInterface(Atspi.Accessible.get_hypertext_iface, x))
-Atspi.Accessible.queryImage = lambda x: Image(getInterface(Atspi.Accessible.get_image_iface, x))
-Atspi.Accessible.querySelection = lambda x: Selection(getInterface(Atspi.Accessible.get_selection_iface, x))
-Atspi.Accessible.queryTable = lambda x: Table(getInterface(Atspi.Accessible.get_table_iface, x))
-Atspi.Accessible.queryTableCell = lambda x: TableCell(getInterface(Atspi.Accessible.get_table_cell, x))
-Atspi.Accessible.queryText = lambda x: Text(getInterface(Atspi.Accessible.get_text_iface, x))
-Atspi.Accessible.queryValue = lambda x: Value(getInterface(Atspi.Accessible.get_value_iface, x))
+Atspi.Accessible.queryHypertext = lambda x: _lazy("Hypertext")(getInterface(Atspi.Accessible.get_hypertext_iface, x))
+Atspi.Accessible.queryImage = lambda x: _lazy("Image")(getInterface(Atspi.Accessible.get_image_iface, x))
+Atspi.Accessible.querySelection = lambda x: _lazy("Selection")(getInterface(Atspi.Accessible.get_selection_iface, x))
+Atspi.Accessible.queryTable = lambda x: _lazy("Table")(getInterface(Atspi.Accessible.get_table_iface, x))
+Atspi.Accessible.queryTableCell = lambda x: _lazy("TableCell")(getInterface(Atspi.Accessible.get_table_cell, x))
+Atspi.Accessible.queryText = lambda x: _lazy("Text")(getInterface(Atspi.Accessible.get_text_iface, x))
+Atspi.Accessible.queryValue = lambda x: _lazy("Value")(getInterface(Atspi.Accessible.get_value_iface, x))
 
 # Doing this here since otherwise we'd have import recursion
-interface.queryAction = lambda x: Action(getInterface(Atspi.Accessible.get_action, x.obj))
-interface.queryCollection = lambda x: Collection(getInterface(Atspi.Accessible.get_collection, x.obj))
-interface.queryComponent = lambda x: Component(getInterface(Atspi.Accessible.get_component, x.obj))
-interface.queryDocument = lambda x: Document(getInterface(Atspi.Accessible.get_document, x.obj))
-interface.queryEditableText = lambda x: EditableText(getInterface(Atspi.Accessible.get_editable_text, x.obj))
+interface.queryAction = lambda x: _lazy("Action")(getInterface(Atspi.Accessible.get_action, x.obj))
+interface.queryCollection = lambda x: _lazy("Collection")(getInterface(Atspi.Accessible.get_collection, x.obj))
+interface.queryComponent = lambda x: _lazy("Component")(getInterface(Atspi.Accessible.get_component, x.obj))
+interface.queryDocument = lambda x: _lazy("Document")(getInterface(Atspi.Accessible.get_document, x.obj))
+interface.queryEditableText = lambda x: _lazy("EditableText")(getInterface(Atspi.Accessible.get_editable_text, x.obj))
 interface.queryHyperlink = lambda x: getInterface(Atspi.Accessible.get_hyperlink, x.obj)
-interface.queryHypertext = lambda x: Hypertext(getInterface(Atspi.Accessible.get_hypertext, x.obj))
-interface.queryImage = lambda x: Image(getInterface(Atspi.Accessible.get_image, x.obj))
-interface.querySelection = lambda x: Selection(getInterface(Atspi.Accessible.get_selection, x.obj))
-interface.queryTable = lambda x: Table(getInterface(Atspi.Accessible.get_table, x.obj))
-interface.queryTableCell = lambda x: Table(getInterface(Atspi.Accessible.get_table_cell, x.obj))
-interface.queryText = lambda x: Text(getInterface(Atspi.Accessible.get_text, x.obj))
-interface.queryValue = lambda x: Value(getInterface(Atspi.Accessible.get_value, x.obj))
+interface.queryHypertext = lambda x: _lazy("Hypertext")(getInterface(Atspi.Accessible.get_hypertext, x.obj))
+interface.queryImage = lambda x: _lazy("Image")(getInterface(Atspi.Accessible.get_image, x.obj))
+interface.querySelection = lambda x: _lazy("Selection")(getInterface(Atspi.Accessible.get_selection, x.obj))
+interface.queryTable = lambda x: _lazy("Table")(getInterface(Atspi.Accessible.get_table, x.obj))
+interface.queryTableCell = lambda x: _lazy("Table")(getInterface(Atspi.Accessible.get_table_cell, x.obj))
+interface.queryText = lambda x: _lazy("Text")(getInterface(Atspi.Accessible.get_text, x.obj))
+interface.queryValue = lambda x: _lazy("Value")(getInterface(Atspi.Accessible.get_value, x.obj))
 
 ### hyperlink ###
 Hyperlink = Atspi.Hyperlink
-Atspi.Hyperlink.getObject = Atspi.Hyperlink.get_object
-Atspi.Hyperlink.getURI = Atspi.Hyperlink.get_uri
-Atspi.Hyperlink.isValid = Atspi.Hyperlink.is_valid
+_alias(Atspi.Hyperlink, "getObject", "get_object")
+_alias(Atspi.Hyperlink, "getURI", "get_uri")
+_alias(Atspi.Hyperlink, "isValid", "is_valid")
 Atspi.Hyperlink.endIndex = property(fget=Atspi.Hyperlink.get_end_index)
 Atspi.Hyperlink.nAnchors = property(fget=Atspi.Hyperlink.get_n_anchors)
 Atspi.Hyperlink.startIndex = property(fget=Atspi.Hyperlink.get_start_index)
@@ -189,9 +264,9 @@ Atspi.Event.type = property(fget=getEventType)
 Atspi.Event.__str__ = Event_str
 
 ### RelationSet ###
-Atspi.Relation.getRelationType = Atspi.Relation.get_relation_type
-Atspi.Relation.getNTargets = Atspi.Relation.get_n_targets
-Atspi.Relation.getTarget = Atspi.Relation.get_target
+_alias(Atspi.Relation, "getRelationType", "get_relation_type")
+_alias(Atspi.Relation, "getNTargets", "get_n_targets")
+_alias(Atspi.Relation, "getTarget", "get_target")
 RELATION_NULL = Atspi.RelationType.NULL
 RELATION_LABEL_FOR = Atspi.RelationType.LABEL_FOR
 RELATION_LABELLED_BY = Atspi.RelationType.LABELLED_BY
@@ -212,12 +287,27 @@ RELATION_PARENT_WINDOW_OF = Atspi.RelationType.PARENT_WINDOW_OF
 RELATION_DESCRIPTION_FOR = Atspi.RelationType.DESCRIPTION_FOR
 RELATION_DESCRIBED_BY = Atspi.RelationType.DESCRIBED_BY
 
-# Build a dictionary mapping relation values to names based on the prefix of the enum constants.
-
-RELATION_VALUE_TO_NAME = dict(((value, name[9:].lower().replace('_', ' ')) 
-                               for name, value 
-                               in globals().items()
-                               if name.startswith('RELATION_')))
+RELATION_VALUE_TO_NAME = {
+        RELATION_NULL:'null',
+        RELATION_LABEL_FOR:'label for',
+        RELATION_LABELLED_BY:'labelled by',
+        RELATION_CONTROLLER_FOR:'controller for',
+        RELATION_CONTROLLED_BY:'controlled by',
+        RELATION_MEMBER_OF:'member of',
+        RELATION_TOOLTIP_FOR:'tooltip for',
+        RELATION_NODE_CHILD_OF:'node child of',
+        RELATION_NODE_PARENT_OF:'node parent of',
+        RELATION_EXTENDED:'extended',
+        RELATION_FLOWS_TO:'flows to',
+        RELATION_FLOWS_FROM:'flows from',
+        RELATION_SUBWINDOW_OF:'subwindow of',
+        RELATION_EMBEDS:'embeds',
+        RELATION_EMBEDDED_BY:'embedded by',
+        RELATION_POPUP_FOR:'popup for',
+        RELATION_PARENT_WINDOW_OF:'parent window of',
+        RELATION_DESCRIPTION_FOR:'description for',
+        RELATION_DESCRIBED_BY:'described by',
+}
 
 ### ModifierType ###
 MODIFIER_SHIFT = Atspi.ModifierType.SHIFT
@@ -25,3 +25,26 @@ from pyatspi.Accessibility import *
 import sys
 import pyatspi.Accessibility as Accessibility
 sys.modules['Accessibility'] = Accessibility
+
+# The interface modules are imported on first use of one of their names;
+# see Accessibility._lazyModules. "from pyatspi import *" still exports
+# every name, and so imports every module. A submodule not imported yet,
+# as in "pyatspi.text.Text", is imported when first used as an attribute.
+if sys.version_info >= (3, 7):
+        from importlib import import_module as _import_module
+
+        def __getattr__(name):
+                if name in Accessibility._lazyNames:
+                        value = Accessibility._lazy(name)
+                        globals()[name] = value
+                        return value
+                if not name.startswith('__'):
+                        try:
+                                return _import_module(__name__ + '.' + name)
+                        except ModuleNotFoundError as error:
+                                if error.name != __name__ + '.' + name:
+                                        raise
+                raise AttributeError("module %r has no attribute %r" % (__name__, name))
+
+        __all__ = sorted(set(name for name in globals() if not name.startswith('_')) |
+                         set(Accessibility._lazyNames))
@@ -18,22 +18,43 @@ __all__ = [
 
 #------------------------------------------------------------------------------
 
-class AtspiEnum(int):
-        def __str__(self):
-                return self._enum_lookup[int(self)]
+# The instances of each AtspiEnum subclass, by class and value
+_enumInstances = {}
 
-        def __eq__(self, other):
-                if other is None:
-                        return False
+class AtspiEnum(int):
+        """
+        Base class of the pyatspi enumerations. There is a single instance
+        for each value of an enumeration, created on first use, and its
+        name is looked up only once.
+
+        Comparison and hashing are those of int, so comparing an enum with
+        another enum or with a plain int costs the same as comparing two
+        ints, and enums with equal values are interchangeable as dictionary
+        keys.
+        """
+
+        def __new__(cls, value):
                 try:
-                        if int(self) == int(other):
-                                return True
-                        else:
-                                return False
-                except ValueError:
-                        return False
-
-        def __hash__(self):
-                return int(self)
+                        return _enumInstances[cls][value]
+                except KeyError:
+                        pass
+                value = int(value)
+                instances = _enumInstances.setdefault(cls, {})
+                instance = instances.get(value)
+                if instance is None:
+                        instance = int.__new__(cls, value)
+                        instance._name = cls._enum_lookup.get(value)
+                        instances[value] = instance
+                return instance
+
+        def __str__(self):
+                name = self._name
+                if name is None:
+                        # not a known value; fails as a lookup would
+                        return self._enum_lookup[int(self)]
+                return name
+
+        def __reduce__(self):
+                return (self.__class__, (int(self),))
 
 #END---------------------------------------------------------------------------
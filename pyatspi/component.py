@@ -13,7 +13,9 @@
 #along with this program; if not, write to the Free Software
 #Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 
-from gi.repository import Atspi
+from array import array
+
+from gi.repository import Atspi, GLib
 from pyatspi.atspienum import *
 from pyatspi.utils import *
 from pyatspi.interface import *
@@ -24,6 +26,7 @@ __all__ = [
            "XY_WINDOW",
            "ComponentLayer",
            "Component",
+           "getExtentsBatch",
            "LAYER_BACKGROUND",
            "LAYER_CANVAS",
            "LAYER_INVALID",
@@ -170,4 +173,34 @@ class Component(interface):
                 """
                 return Atspi.Component.grab_focus(self.obj)
 
+#------------------------------------------------------------------------------
+
+def getExtentsBatch(accessibles, coord_type):
+        """
+        Obtain the extents of many components at once, without building a
+        BoundingBox for each of them.
+        @param : accessibles
+        a sequence of accessibles implementing Component.
+        @param : coord_type
+        @return an array('i') holding x, y, width and height for each
+        accessible in turn. The extents of an accessible whose application
+        returned an error, for instance because it has gone away or does
+        not implement Component, are (-1, -1, -1, -1), as for unknown
+        extents in ATK; such a box is empty.
+        """
+        accessibles = list(accessibles)
+        extents = array('i', (-1, -1, -1, -1)) * len(accessibles)
+        offset = 0
+        for accessible in accessibles:
+                try:
+                        rect = Atspi.Component.get_extents(accessible, coord_type)
+                        extents[offset] = rect.x
+                        extents[offset + 1] = rect.y
+                        extents[offset + 2] = rect.width
+                        extents[offset + 3] = rect.height
+                except GLib.GError:
+                        pass
+                offset += 4
+        return extents
+
 #END----------------------------------------------------------------------------
@@ -12,6 +12,8 @@
 #along with this program; if not, write to the Free Software
 #Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 
+from gi.repository import Atspi
+
 import pyatspi.registry as registry
 
 from pyatspi.atspienum import *
@@ -110,7 +112,72 @@ def allModifiers():
 
 #------------------------------------------------------------------------------
 
-class DeviceEvent(list):
+class _Record(object):
+        """
+        Base of the small records below: a fixed set of attributes, listed
+        in _fields, that can also be read and written by index, unpacked,
+        searched, concatenated and compared with lists, as when the records
+        were lists. They are no longer instances of list.
+        """
+
+        __slots__ = ()
+        _fields = ()
+
+        def __len__(self):
+                return len(self._fields)
+
+        def __iter__(self):
+                for field in self._fields:
+                        yield getattr(self, field)
+
+        def __getitem__(self, index):
+                if isinstance(index, slice):
+                        return list(self)[index]
+                return getattr(self, self._fields[index])
+
+        def __setitem__(self, index, value):
+                setattr(self, self._fields[index], value)
+
+        def index(self, value, *args):
+                return list(self).index(value, *args)
+
+        def count(self, value):
+                return list(self).count(value)
+
+        def __add__(self, other):
+                if isinstance(other, _Record):
+                        other = list(other)
+                return list(self) + other
+
+        def __radd__(self, other):
+                return other + list(self)
+
+        def __eq__(self, other):
+                if isinstance(other, (_Record, list, tuple)):
+                        return list(self) == list(other)
+                return NotImplemented
+
+        def __ne__(self, other):
+                result = self.__eq__(other)
+                if result is NotImplemented:
+                        return result
+                return not result
+
+        __hash__ = None
+
+        def __repr__(self):
+                return repr(list(self))
+
+        def __getstate__(self):
+                return [getattr(self, name) for name in self.__slots__]
+
+        def __setstate__(self, state):
+                for name, value in zip(self.__slots__, state):
+                        setattr(self, name, value)
+
+#------------------------------------------------------------------------------
+
+class DeviceEvent(_Record):
         """
         Wraps an AT-SPI device event with a more Pythonic interface. Primarily adds
         a consume attribute which can be used to cease propagation of a device event.
@@ -136,46 +203,19 @@ class DeviceEvent(list):
                 of a control key (False)?
         @type is_text: boolean
         """
-        def __new__(cls, type, id, hw_code, modifiers, timestamp, event_string, is_text):
-                return list.__new__(cls, (type, id, hw_code, modifiers, timestamp, event_string, is_text))
+        __slots__ = ("type", "id", "hw_code", "modifiers", "timestamp", "event_string",
+                     "is_text", "consume")
+        _fields = __slots__[:7]
+
         def __init__(self, type, id, hw_code, modifiers, timestamp, event_string, is_text):
-                list.__init__(self, (type, id, hw_code, modifiers, timestamp, event_string, is_text))
+                self.type = type
+                self.id = id
+                self.hw_code = hw_code
+                self.modifiers = modifiers
+                self.timestamp = timestamp
+                self.event_string = event_string
+                self.is_text = is_text
                 self.consume = False
-        def _get_type(self):
-                return self[0]
-        def _set_type(self, val):
-                self[0] = val
-        type = property(fget=_get_type, fset=_set_type)
-        def _get_id(self):
-                return self[1]
-        def _set_id(self, val):
-                self[1] = val
-        id = property(fget=_get_id, fset=_set_id)
-        def _get_hw_code(self):
-                return self[2]
-        def _set_hw_code(self, val):
-                self[2] = val
-        hw_code = property(fget=_get_hw_code, fset=_set_hw_code)
-        def _get_modifiers(self):
-                return self[3]
-        def _set_modifiers(self, val):
-                self[3] = val
-        modifiers = property(fget=_get_modifiers, fset=_set_modifiers)
-        def _get_timestamp(self):
-                return self[4]
-        def _set_timestamp(self, val):
-                self[4] = val
-        timestamp = property(fget=_get_timestamp, fset=_set_timestamp)
-        def _get_event_string(self):
-                return self[5]
-        def _set_event_string(self, val):
-                self[5] = val
-        event_string = property(fget=_get_event_string, fset=_set_event_string)
-        def _get_is_text(self):
-                return self[6]
-        def _set_is_text(self, val):
-                self[6] = val
-        is_text = property(fget=_get_is_text, fset=_set_is_text)
 
         def __str__(self):
                 """
@@ -184,11 +224,12 @@ class DeviceEvent(list):
                 @return: Event description
                 @rtype: string
                 """
-                import constants
-                if self.type == constants.KEY_PRESSED_EVENT:
+                if self.type == Atspi.EventType.KEY_PRESSED_EVENT:
                         kind = 'pressed'
-                elif self.type == constants.KEY_RELEASED_EVENT:
+                elif self.type == Atspi.EventType.KEY_RELEASED_EVENT:
                         kind = 'released'
+                else:
+                        kind = 'unknown'
                 return """\
 %s
 \thw_code: %d
@@ -201,51 +242,24 @@ class DeviceEvent(list):
 
 #------------------------------------------------------------------------------
 
-class EventListenerMode(list):
-        def __new__(cls, synchronous, preemptive, global_):
-                return list.__new__(cls, (synchronous, preemptive, global_))
+class EventListenerMode(_Record):
+        __slots__ = ("synchronous", "preemptive", "global_")
+        _fields = __slots__
+
         def __init__(self, synchronous, preemptive, global_):
-                list.__init__(self, (synchronous, preemptive, global_))
-        def _get_synchronous(self):
-                return self[0]
-        def _set_synchronous(self, val):
-                self[0] = val
-        synchronous = property(fget=_get_synchronous, fset=_set_synchronous)
-        def _get_preemptive(self):
-                return self[1]
-        def _set_preemptive(self, val):
-                self[1] = val
-        preemptive = property(fget=_get_preemptive, fset=_set_preemptive)
-        def _get_global_(self):
-                return self[2]
-        def _set_global_(self, val):
-                self[2] = val
-        global_ = property(fget=_get_global_, fset=_set_global_)
+                self.synchronous = synchronous
+                self.preemptive = preemptive
+                self.global_ = global_
 
 #------------------------------------------------------------------------------
 
-class KeyDefinition(list):
-        def __new__(cls, keycode, keysym, keystring, unused):
-                return list.__new__(cls, (keycode, keysym, keystring, unused))
+class KeyDefinition(_Record):
+        __slots__ = ("keycode", "keysym", "keystring", "unused")
+        _fields = __slots__
+
         def __init__(self, keycode, keysym, keystring, unused):
-                list.__init__(self, (keycode, keysym, keystring, unused))
-        def _get_keycode(self):
-                return self[0]
-        def _set_keycode(self, val):
-                self[0] = val
-        keycode = property(fget=_get_keycode, fset=_set_keycode)
-        def _get_keysym(self):
-                return self[1]
-        def _set_keysym(self, val):
-                self[1] = val
-        keysym = property(fget=_get_keysym, fset=_set_keysym)
-        def _get_keystring(self):
-                return self[2]
-        def _set_keystring(self, val):
-                self[2] = val
-        keystring = property(fget=_get_keystring, fset=_set_keystring)
-        def _get_unused(self):
-                return self[3]
-        def _set_unused(self, val):
-                self[3] = val
-        unused = property(fget=_get_unused, fset=_set_unused)
+                self.keycode = keycode
+                self.keysym = keysym
+                self.keystring = keystring
+                self.unused = unused
+
@@ -0,0 +1,332 @@
+#This library is free software; you can redistribute it and/or
+#modify it under the terms of the GNU Lesser General Public
+#License version 2 as published by the Free Software Foundation.
+
+#This program is distributed in the hope that it will be useful,
+#but WITHOUT ANY WARRANTY; without even the implied warranty of
+#MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#GNU General Public License for more details.
+#You should have received a copy of the GNU Lesser General Public License
+#along with this program; if not, write to the Free Software
+#Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+import mmap
+import struct
+import sys
+import time
+from array import array
+from collections import namedtuple
+
+__all__ = [
+           "EventTraceWriter",
+           "EventTraceReader",
+           "TraceEvent",
+          ]
+
+#------------------------------------------------------------------------------
+
+# An event trace is a header followed by chunks. A chunk starts with its
+# kind, the size of its payload, a count and the times of its first and
+# last events, so that a reader can skip it without reading the payload.
+#
+# A string chunk adds count strings to the string table, each as its
+# length and its UTF-8 encoding. Event types, sources and any_data
+# summaries are stored as indexes in this table; a string chunk is always
+# written before the first event chunk that uses its strings.
+#
+# An event chunk holds count events as columns: types, sources, detail1,
+# detail2, any_data summaries, then times in seconds since the epoch.
+# All values are little endian.
+
+_HEADER = b"PYATSPI-TRACE\x00\x00\x01"
+_CHUNK = struct.Struct("<cIIdd")
+_STRINGS = b"S"
+_EVENTS = b"E"
+_LENGTH = struct.Struct("<I")
+
+# array type code and item size of each column of an event chunk
+_COLUMNS = (("I", 4), ("I", 4), ("i", 4), ("i", 4), ("I", 4), ("d", 8))
+_TYPE, _SOURCE, _DETAIL1, _DETAIL2, _ANY_DATA, _TIME = range(6)
+
+_SUMMARY_LENGTH = 64
+
+if hasattr(array, "tobytes"):
+        def _toBytes(column):
+                return column.tobytes()
+        def _fromBytes(column, data):
+                column.frombytes(data)
+else:
+        def _toBytes(column):
+                return column.tostring()
+        def _fromBytes(column, data):
+                column.fromstring(data)
+
+_swap = sys.byteorder != "little"
+
+def _sourcePath(accessible):
+        # The bus name and object path identify an accessible without a
+        # call to its application.
+        if accessible is None:
+                return ""
+        try:
+                return "%s%s" % (accessible.app.bus_name, accessible.path)
+        except AttributeError:
+                return "unknown"
+
+def _summary(value):
+        if value is None:
+                return ""
+        if isinstance(value, (bool, int, float)):
+                return repr(value)
+        if isinstance(value, str) or (str is bytes and isinstance(value, unicode)):
+                return value[:_SUMMARY_LENGTH]
+        if hasattr(value, "getRole"):
+                return _sourcePath(value)
+        return type(value).__name__
+
+TraceEvent = namedtuple("TraceEvent",
+                        ("time", "type", "source", "detail1", "detail2", "any_data"))
+
+#------------------------------------------------------------------------------
+
+class EventTraceWriter(object):
+        """
+        Writes the events it is given to an event trace. Events are kept in
+        memory and written a chunk at a time, or when flush() is called;
+        events not yet written are lost if the process dies. Strings are
+        written once, to the string table, and referred to by index.
+
+        Sources, and accessibles in any_data, are recorded as their bus name
+        followed by their object path, or as "unknown" for an object that
+        has neither.
+
+        A writer is an event listener client, as registered by
+        Registry.startEventTrace.
+        """
+
+        def __init__(self, filename, chunkSize=4096):
+                """
+                @param : filename
+                the trace to write. An existing file is replaced.
+                @param : chunkSize
+                the number of events in each chunk.
+                """
+                self._file = open(filename, "wb")
+                self._file.write(_HEADER)
+                self.chunkSize = chunkSize
+                self.count = 0
+                self._strings = {"": 0}
+                self._newStrings = [""]
+                self._columns = [array(code) for code, size in _COLUMNS]
+
+        def _intern(self, string):
+                try:
+                        return self._strings[string]
+                except KeyError:
+                        index = self._strings[string] = len(self._strings)
+                        self._newStrings.append(string)
+                        return index
+
+        def record(self, event, timestamp=None):
+                """
+                Adds an event to the trace.
+
+                @param : timestamp
+                the time the event was received, in seconds since the epoch.
+                Defaults to the current time.
+                """
+                columns = self._columns
+                columns[_TYPE].append(self._intern(str(event.type)))
+                columns[_SOURCE].append(self._intern(_sourcePath(event.source)))
+                columns[_DETAIL1].append(event.detail1)
+                columns[_DETAIL2].append(event.detail2)
+                try:
+                        anyData = _summary(event.any_data)
+                except Exception:
+                        anyData = ""
+                columns[_ANY_DATA].append(self._intern(anyData))
+                columns[_TIME].append(time.time() if timestamp is None else timestamp)
+                self.count += 1
+                if len(columns[_TIME]) >= self.chunkSize:
+                        self.flush()
+
+        def __call__(self, event):
+                self.record(event)
+
+        def flush(self):
+                """
+                Writes the events kept in memory as a chunk.
+                """
+                if self._newStrings:
+                        payload = []
+                        for string in self._newStrings:
+                                data = string if isinstance(string, bytes) else string.encode("utf-8")
+                                payload.append(_LENGTH.pack(len(data)))
+                                payload.append(data)
+                        payload = b"".join(payload)
+                        self._file.write(_CHUNK.pack(_STRINGS, len(payload),
+                                                     len(self._newStrings), 0, 0))
+                        self._file.write(payload)
+                        self._newStrings = []
+                columns = self._columns
+                times = columns[_TIME]
+                if times:
+                        if _swap:
+                                for column in columns:
+                                        column.byteswap()
+                        payload = b"".join(_toBytes(column) for column in columns)
+                        if _swap:
+                                times.byteswap()
+                        self._file.write(_CHUNK.pack(_EVENTS, len(payload), len(times),
+                                                     min(times), max(times)))
+                        self._file.write(payload)
+                        self._columns = [array(code) for code, size in _COLUMNS]
+                self._file.flush()
+
+        def close(self):
+                self.flush()
+                self._file.close()
+
+#------------------------------------------------------------------------------
+
+class EventTraceReader(object):
+        """
+        Reads an event trace. The trace is mapped in memory; opening it
+        reads the chunk headers and the string table, and a query only
+        decodes the columns it filters on in the chunks overlapping its
+        time range, then the other columns of the matching events.
+        """
+
+        def __init__(self, filename):
+                self._file = open(filename, "rb")
+                self._map = None
+                self.strings = []
+                self._chunks = []
+                size = self._file.seek(0, 2) or self._file.tell()
+                if size < len(_HEADER):
+                        return
+                self._map = data = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+                if data[:len(_HEADER)] != _HEADER:
+                        self.close()
+                        raise ValueError("%s is not an event trace" % filename)
+                offset = len(_HEADER)
+                while offset + _CHUNK.size <= size:
+                        kind, length, count, first, last = _CHUNK.unpack_from(data, offset)
+                        offset += _CHUNK.size
+                        if offset + length > size:
+                                # cut short, as after a crash
+                                break
+                        if kind == _STRINGS:
+                                self._readStrings(offset, count)
+                        elif kind == _EVENTS:
+                                self._chunks.append((offset, count, first, last))
+                        offset += length
+
+        def _readStrings(self, offset, count):
+                data = self._map
+                for i in range(count):
+                        length, = _LENGTH.unpack_from(data, offset)
+                        offset += _LENGTH.size
+                        string = data[offset:offset + length]
+                        if str is not bytes:
+                                string = string.decode("utf-8")
+                        self.strings.append(string)
+                        offset += length
+
+        def __len__(self):
+                return sum(count for offset, count, first, last in self._chunks)
+
+        def _column(self, chunk, index):
+                offset, count, first, last = chunk
+                for code, size in _COLUMNS[:index]:
+                        offset += size * count
+                code, size = _COLUMNS[index]
+                column = array(code)
+                _fromBytes(column, self._map[offset:offset + size * count])
+                if _swap:
+                        column.byteswap()
+                return column
+
+        def _ids(self, names, prefixes):
+                if names is None:
+                        return None
+                if isinstance(names, str):
+                        names = (names,)
+                names = set(names)
+                ids = set()
+                for index, string in enumerate(self.strings):
+                        if string in names:
+                                ids.add(index)
+                        elif prefixes:
+                                for name in names:
+                                        if string.startswith(name + ":"):
+                                                ids.add(index)
+                                                break
+                return ids
+
+        def query(self, types=None, sources=None, start=None, end=None):
+                """
+                Finds the events of given types or sources in a time range.
+
+                @param : types
+                event names, full or partial as given to
+                Registry.registerEventListener. None matches all types.
+                @param : sources
+                source paths, as in the source field of the events returned.
+                None matches all sources.
+                @param : start
+                the earliest time to match, in seconds since the epoch.
+                @param : end
+                the latest time to match.
+                @return a list of TraceEvent, in the order they were recorded.
+                """
+                typeIds = self._ids(types, True)
+                sourceIds = self._ids(sources, False)
+                if typeIds is not None and not typeIds or sourceIds is not None and not sourceIds:
+                        return []
+                strings = self.strings
+                events = []
+                for chunk in self._chunks:
+                        offset, count, first, last = chunk
+                        if start is not None and last < start or end is not None and first > end:
+                                continue
+                        rows = range(count)
+                        times = None
+                        if start is not None and first < start or end is not None and last > end:
+                                times = self._column(chunk, _TIME)
+                                rows = [i for i in rows
+                                        if (start is None or times[i] >= start) and
+                                           (end is None or times[i] <= end)]
+                        typeColumn = None
+                        if typeIds is not None and rows:
+                                typeColumn = self._column(chunk, _TYPE)
+                                rows = [i for i in rows if typeColumn[i] in typeIds]
+                        sourceColumn = None
+                        if sourceIds is not None and rows:
+                                sourceColumn = self._column(chunk, _SOURCE)
+                                rows = [i for i in rows if sourceColumn[i] in sourceIds]
+                        if not rows:
+                                continue
+                        if times is None:
+                                times = self._column(chunk, _TIME)
+                        if typeColumn is None:
+                                typeColumn = self._column(chunk, _TYPE)
+                        if sourceColumn is None:
+                                sourceColumn = self._column(chunk, _SOURCE)
+                        detail1 = self._column(chunk, _DETAIL1)
+                        detail2 = self._column(chunk, _DETAIL2)
+                        anyData = self._column(chunk, _ANY_DATA)
+                        for i in rows:
+                                events.append(TraceEvent(times[i], strings[typeColumn[i]],
+                                                         strings[sourceColumn[i]],
+                                                         detail1[i], detail2[i],
+                                                         strings[anyData[i]]))
+                return events
+
+        def close(self):
+                if self._map is not None:
+                        self._map.close()
+                        self._map = None
+                self._file.close()
+
+#END----------------------------------------------------------------------------
@@ -0,0 +1,184 @@
+#This library is free software; you can redistribute it and/or
+#modify it under the terms of the GNU Lesser General Public
+#License version 2 as published by the Free Software Foundation.
+
+#This program is distributed in the hope that it will be useful,
+#but WITHOUT ANY WARRANTY; without even the implied warranty of
+#MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#GNU General Public License for more details.
+#You should have received a copy of the GNU Lesser General Public License
+#along with this program; if not, write to the Free Software
+#Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+import time
+from collections import deque
+
+__all__ = [
+           "FocusTracker",
+          ]
+
+#------------------------------------------------------------------------------
+
+_focusTrackerEvents = (
+        "object:state-changed:focused",
+        "object:property-change:accessible-parent",
+)
+
+class FocusTracker(object):
+        """
+        Follows focus changes and keeps the focused accessible, its
+        ancestors and the recent focus history in memory, so that they can
+        be queried without going back to the applications.
+
+        When the focus moves, only the ancestors of the new focus that are
+        not already known are fetched: the walk up the tree stops at the
+        first object that is in the previous chain.
+        """
+
+        def __init__(self, historySize=32):
+                """
+                @param : historySize
+                the number of focus changes kept in the history.
+                """
+                self._focus = None
+                self._ancestors = ()
+                self._positions = {}
+                self._history = deque(maxlen=historySize)
+
+        def start(self):
+                """
+                Starts following focus changes.
+                """
+                from pyatspi.Accessibility import Registry
+                Registry.registerEventListener(self.handleEvent, *_focusTrackerEvents)
+
+        def stop(self):
+                """
+                Stops following focus changes.
+                """
+                from pyatspi.Accessibility import Registry
+                Registry.deregisterEventListener(self.handleEvent, *_focusTrackerEvents)
+
+        def handleEvent(self, event):
+                """
+                Updates the focus from an event, as done for the events
+                followed after start: a focused state change, or a parent
+                change of an object in the chain of the focus.
+
+                @param : event
+                an event with the type, source and detail1 of an L{Event}.
+                """
+                if event.type.startswith("object:property-change"):
+                        if event.source in self._positions:
+                                self._setChain(self._focus, ())
+                elif event.detail1:
+                        self.setFocus(event.source)
+                elif event.source == self._focus:
+                        self._setChain(None, ())
+
+        def setFocus(self, accessible):
+                """
+                Records a focus change, as when a focused event is received.
+
+                @param : accessible
+                the accessible that gained the focus.
+                """
+                self._history.append((time.time(), accessible))
+                ancestors = []
+                seen = set()
+                try:
+                        parent = accessible.parent
+                        while parent is not None and parent not in seen:
+                                position = self._positions.get(parent)
+                                if position is not None:
+                                        ancestors.extend(self._chain()[position:])
+                                        break
+                                ancestors.append(parent)
+                                seen.add(parent)
+                                parent = parent.parent
+                except Exception:
+                        pass
+                self._setChain(accessible, ancestors)
+
+        def _chain(self):
+                return (self._focus,) + self._ancestors
+
+        def _setChain(self, focus, ancestors):
+                self._focus = focus
+                if focus is not None and not ancestors:
+                        # the ancestors were dropped; fetch them again next time
+                        ancestors = self._fetchAncestors(focus)
+                self._ancestors = tuple(ancestors)
+                self._positions = {}
+                if focus is not None:
+                        for position, accessible in enumerate(self._chain()):
+                                self._positions.setdefault(accessible, position)
+
+        def _fetchAncestors(self, accessible):
+                ancestors = []
+                try:
+                        parent = accessible.parent
+                        while parent is not None and parent not in ancestors:
+                                ancestors.append(parent)
+                                parent = parent.parent
+                except Exception:
+                        pass
+                return ancestors
+
+        def getFocus(self):
+                """
+                @return the accessible that has the focus, or None.
+                """
+                return self._focus
+
+        def getAncestors(self):
+                """
+                @return the ancestors of the focused accessible, from its
+                parent up to the top of the hierarchy.
+                """
+                return list(self._ancestors)
+
+        def findAncestor(self, pred):
+                """
+                Searches the ancestors of the focused accessible for one
+                satisfying a predicate, like pyatspi.findAncestor, without
+                querying the parent of each object.
+
+                @param : pred
+                a callable returning True for the accessible searched for.
+                @return the nearest matching ancestor, or None.
+                """
+                for accessible in self._ancestors:
+                        try:
+                                if pred(accessible):
+                                        return accessible
+                        except Exception:
+                                pass
+                return None
+
+        def isInside(self, accessible):
+                """
+                @return True if the focused accessible is the given accessible
+                or one of its descendants.
+                """
+                return self._focus is not None and accessible in self._positions
+
+        def getHistory(self):
+                """
+                @return the recent focus changes, oldest first, as
+                (timestamp, accessible) pairs. Timestamps are in seconds,
+                as returned by time.time().
+                """
+                return list(self._history)
+
+        def getPreviousFocus(self):
+                """
+                @return the accessible focused before the current one that is
+                not the current one, or None.
+                """
+                for timestamp, accessible in reversed(self._history):
+                        if accessible != self._focus:
+                                return accessible
+                return None
+
+#END----------------------------------------------------------------------------
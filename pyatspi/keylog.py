@@ -0,0 +1,184 @@
+#This library is free software; you can redistribute it and/or
+#modify it under the terms of the GNU Lesser General Public
+#License version 2 as published by the Free Software Foundation.
+
+#This program is distributed in the hope that it will be useful,
+#but WITHOUT ANY WARRANTY; without even the implied warranty of
+#MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#GNU General Public License for more details.
+#You should have received a copy of the GNU Lesser General Public License
+#along with this program; if not, write to the Free Software
+#Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+import mmap
+import struct
+import time
+
+from pyatspi.deviceevent import DeviceEvent
+
+__all__ = [
+           "KeyRecorder",
+           "KeyLogReader",
+           "replayKeyLog",
+          ]
+
+#------------------------------------------------------------------------------
+
+# A key log is a header followed by records. Each record is its length, as
+# an unsigned 32 bit integer, then the fixed fields and the UTF-8 encoded
+# event string. All integers are little endian.
+
+_HEADER = b"PYATSPI-KEYLOG\x00\x01"
+_LENGTH = struct.Struct("<I")
+# type, id, hw_code, modifiers, timestamp, is_text
+_FIELDS = struct.Struct("<BiiIIB")
+
+class KeyRecorder(object):
+        """
+        Appends the key events it is given to a key log. A recorder is a
+        keystroke listener client that never consumes events, so it can be
+        registered as it is; wrap() records the events reaching another
+        client instead.
+        """
+
+        def __init__(self, filename):
+                """
+                @param : filename
+                the log to append to. A new file gets a header.
+                """
+                self._file = open(filename, "ab")
+                if self._file.tell() == 0:
+                        self._file.write(_HEADER)
+                self.count = 0
+
+        def record(self, event):
+                """
+                Appends an event to the log.
+                """
+                string = event.event_string or ""
+                if not isinstance(string, bytes):
+                        string = string.encode("utf-8")
+                fields = _FIELDS.pack(int(event.type), event.id, event.hw_code,
+                                      event.modifiers & 0xFFFFFFFF,
+                                      event.timestamp & 0xFFFFFFFF,
+                                      1 if event.is_text else 0)
+                self._file.write(_LENGTH.pack(len(fields) + len(string)) + fields + string)
+                self.count += 1
+
+        def __call__(self, event):
+                self.record(event)
+                return False
+
+        def wrap(self, client):
+                """
+                @return a callable that records each event, then passes it to
+                client and returns its result.
+                """
+                def recordingClient(event):
+                        self.record(event)
+                        return client(event)
+                return recordingClient
+
+        def flush(self):
+                self._file.flush()
+
+        def close(self):
+                self._file.close()
+
+#------------------------------------------------------------------------------
+
+class KeyLogReader(object):
+        """
+        Reads the events of a key log. The log is mapped in memory and
+        decoded as it is iterated.
+        """
+
+        def __init__(self, filename):
+                self._file = open(filename, "rb")
+                self._map = None
+                size = self._file.seek(0, 2) or self._file.tell()
+                if size > len(_HEADER):
+                        self._map = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+                        if self._map[:len(_HEADER)] != _HEADER:
+                                self.close()
+                                raise ValueError("%s is not a key log" % filename)
+
+        def __iter__(self):
+                """
+                Yields the events of the log as DeviceEvent objects. A record
+                cut short at the end of the log, as after a crash, is ignored.
+                """
+                data = self._map
+                if data is None:
+                        return
+                size = len(data)
+                offset = len(_HEADER)
+                fixed = _FIELDS.size
+                while offset + _LENGTH.size <= size:
+                        length, = _LENGTH.unpack_from(data, offset)
+                        offset += _LENGTH.size
+                        if length < fixed or offset + length > size:
+                                break
+                        type, id, hw_code, modifiers, timestamp, is_text = \
+                                _FIELDS.unpack_from(data, offset)
+                        string = data[offset + fixed:offset + length]
+                        if str is not bytes:
+                                string = string.decode("utf-8")
+                        offset += length
+                        yield DeviceEvent(type, id, hw_code, modifiers, timestamp,
+                                          string, bool(is_text))
+
+        def close(self):
+                if self._map is not None:
+                        self._map.close()
+                        self._map = None
+                self._file.close()
+
+#------------------------------------------------------------------------------
+
+def replayKeyLog(filename, clients=None, speed=1.0):
+        """
+        Feeds the events of a key log to keystroke listener clients, through
+        the same dispatch path as events from the registry daemon.
+
+        @param : filename
+        the key log.
+        @param : clients
+        the callables to feed. By default, the clients registered with
+        Registry.registerKeystrokeListener, through their key filters.
+        @param : speed
+        how much faster than recorded the events are replayed, using their
+        timestamps. 0 replays them without waiting.
+        @return the number of events replayed.
+        """
+        from pyatspi.Accessibility import Registry
+        if clients is None:
+                if not Registry.has_implementations:
+                        Registry._set_default_registry()
+                clients = [keyFilter for listener, keyFilter in Registry.keystroke_listeners.values()]
+        reader = KeyLogReader(filename)
+        count = 0
+        previous = None
+        start = time.time()
+        elapsed = 0.0
+        try:
+                for event in reader:
+                        if speed and previous is not None:
+                                # timestamps are milliseconds, modulo 2^32; a
+                                # step back, as between two recording sessions,
+                                # is replayed without waiting
+                                step = (event.timestamp - previous) & 0xFFFFFFFF
+                                if step < 0x80000000:
+                                        elapsed += step / 1000.0 / speed
+                                delay = start + elapsed - time.time()
+                                if delay > 0:
+                                        time.sleep(delay)
+                        previous = event.timestamp
+                        for client in clients:
+                                Registry.eventWrapper(event, client)
+                        count += 1
+        finally:
+                reader.close()
+        return count
+
+#END----------------------------------------------------------------------------
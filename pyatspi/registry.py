@@ -23,6 +23,7 @@
 #------------------------------------------------------------------------------
 
 __all__ = ["Registry",
+           "KeyBindings",
            "MAIN_LOOP_GLIB",
            "MAIN_LOOP_NONE",
            "set_default_registry"]
@@ -40,6 +41,297 @@ MAIN_LOOP_NONE = 'None'
 
 #------------------------------------------------------------------------------
 
+class KeyBindings(object):
+        """
+        A table of key bindings for L{Registry.registerKeyBindings}, keyed on
+        key and modifiers. When a key event arrives, whether to consume it is
+        decided from the table alone, with a dictionary lookup, so that the
+        answer reaches the registry daemon well before its timeout however
+        slow the handlers are. The handlers run afterwards, from the main
+        loop.
+
+        Keys are given as keysyms, the id of device events, or as hardware
+        key codes; a keysym binding wins over a key code binding.
+
+        @@ivar worstDecisionTime: Longest time, in seconds, taken to answer
+                whether to consume an event, including queueing or running its
+                handler, or None if not measured
+        @@type worstDecisionTime: float
+        """
+
+        def __init__(self):
+                self._keysyms = {}
+                self._keycodes = {}
+                self.worstDecisionTime = None
+
+        def add(self, handler, keysym=None, keycode=None, modifiers=0, consume=True):
+                """
+                Binds a key to a handler.
+
+                @@param handler: Called with a L{deviceevent.DeviceEvent} after the
+                        event has been consumed or passed on; its return value is
+                        ignored. May be None.
+                @@type handler: callable
+                @@param keysym: Keysym of the key
+                @@type keysym: integer
+                @@param keycode: Hardware key code of the key, if no keysym is given
+                @@type keycode: integer
+                @@param modifiers: Modifier mask that must be held, exactly
+                @@type modifiers: integer
+                @@param consume: Should the key event be consumed?
+                @@type consume: boolean
+                """
+                entry = (bool(consume), handler)
+                if keysym is not None:
+                        self._keysyms[(keysym, modifiers & 0xFF)] = entry
+                elif keycode is not None:
+                        self._keycodes[(keycode, modifiers & 0xFF)] = entry
+                else:
+                        raise ValueError("a keysym or a keycode is required")
+
+        def remove(self, keysym=None, keycode=None, modifiers=0):
+                """
+                Removes the binding of a key, if any.
+                """
+                if keysym is not None:
+                        self._keysyms.pop((keysym, modifiers & 0xFF), None)
+                elif keycode is not None:
+                        self._keycodes.pop((keycode, modifiers & 0xFF), None)
+
+        def masks(self):
+                """
+                @@return: The modifier masks used by the bindings
+                @@rtype: list of integer
+                """
+                return sorted(set(mask for key, mask in self._keysyms) |
+                              set(mask for key, mask in self._keycodes))
+
+        def lookup(self, event):
+                """
+                @@return: The (consume, handler) pair bound to the key of an event,
+                        or None
+                @@rtype: tuple
+                """
+                modifiers = event.modifiers & 0xFF
+                entry = self._keysyms.get((event.id, modifiers))
+                if entry is None:
+                        entry = self._keycodes.get((event.hw_code, modifiers))
+                return entry
+
+        def __len__(self):
+                return len(self._keysyms) + len(self._keycodes)
+
+class _KeyBindingsDispatcher(object):
+        # The client of the keystroke listener of a KeyBindings table.
+
+        def __init__(self, bindings, deferred, timed):
+                from pyatspi.deviceevent import DeviceEvent
+                self.bindings = bindings
+                self.deferred = deferred
+                self.timed = timed
+                # the modifier masks registered for the bindings
+                self.masks = []
+                self.deviceEvent = DeviceEvent
+
+        def __call__(self, event):
+                if self.timed:
+                        start = time.time()
+                entry = self.bindings.lookup(event)
+                if entry is None:
+                        consume = False
+                else:
+                        consume, handler = entry
+                        if handler is not None:
+                                # The Atspi event is only valid during this call.
+                                copy = self.deviceEvent(event.type, event.id, event.hw_code,
+                                                        event.modifiers, event.timestamp,
+                                                        event.event_string, event.is_text)
+                                copy.consume = consume
+                                if self.deferred:
+                                        GLib.idle_add(self._run, handler, copy)
+                                else:
+                                        self._run(handler, copy)
+                if self.timed:
+                        # Everything the registry daemon waits for.
+                        elapsed = time.time() - start
+                        worst = self.bindings.worstDecisionTime
+                        if worst is None or elapsed > worst:
+                                self.bindings.worstDecisionTime = elapsed
+                return consume
+
+        def _run(self, handler, event):
+                handler(event)
+                return False
+
+#------------------------------------------------------------------------------
+
+class _InputSequence(object):
+        """
+        A sequence of synthesized events being played by
+        L{Registry.generateInputSequence}. Steps are (delay, function,
+        arguments) triples, the delay being in milliseconds before the step.
+        """
+
+        def __init__(self, steps, callback):
+                self.steps = steps
+                self.callback = callback
+                self.position = 0
+                self.source = None
+                self.done = False
+                self.error = None
+
+        def play(self):
+                try:
+                        for delay, function, args in self.steps:
+                                if delay:
+                                        time.sleep(delay / 1000.0)
+                                function(*args)
+                except Exception as e:
+                        self.error = e
+                        self._finish()
+                        raise
+                self._finish()
+
+        def start(self):
+                self._schedule()
+
+        def _schedule(self):
+                if self.position >= len(self.steps):
+                        self._finish()
+                        return
+                delay = self.steps[self.position][0]
+                if delay:
+                        self.source = GLib.timeout_add(delay, self._run)
+                else:
+                        self.source = GLib.idle_add(self._run)
+
+        def _run(self):
+                # Plays every step up to the next delay in one go. A step that
+                # fails ends the sequence; the error is kept in self.error.
+                self.source = None
+                try:
+                        while True:
+                                delay, function, args = self.steps[self.position]
+                                function(*args)
+                                self.position += 1
+                                if self.position >= len(self.steps) or self.steps[self.position][0]:
+                                        break
+                except Exception as e:
+                        self.error = e
+                        self._finish()
+                        return False
+                self._schedule()
+                return False
+
+        def cancel(self):
+                """
+                Stops playing the sequence. The completion callback is not
+                called.
+                """
+                if self.source is not None:
+                        GLib.source_remove(self.source)
+                        self.source = None
+                self.done = True
+
+        def _finish(self):
+                self.done = True
+                if self.callback is not None:
+                        self.callback()
+
+#------------------------------------------------------------------------------
+
+def _keyCode(key):
+        # Key sets hold hardware key codes, or key definitions of which only
+        # the key code can be compared with a device event.
+        if isinstance(key, int):
+                return key
+        try:
+                return key.keycode or None
+        except AttributeError:
+                return None
+
+class _KeystrokeFilter(object):
+        """
+        All the keystroke registrations of one client, compiled into a table
+        from modifier mask and event kind bit to the key codes wanted, None
+        standing for any key. The native registrations are derived from the
+        same data: one per distinct mask, kind and sync type, with the union
+        of the key sets registered for it, so registering the same masks
+        again or for other keys does not add native listeners.
+        """
+
+        def __init__(self, client):
+                self.client = client
+                # (mask, kind, sync type) -> list of key sets, [] for any key
+                self.registrations = {}
+                # (mask, kind bit) -> frozenset of key codes, or None for any key
+                self.table = {}
+
+        def add(self, key_set, masks, kind, syncFlag):
+                key_set = list(key_set)
+                for mask in masks:
+                        sets = self.registrations.setdefault((mask, kind, syncFlag), [])
+                        if key_set not in sets:
+                                sets.append(key_set)
+                self._compile()
+
+        def remove(self, masks, kind):
+                # Like the registry daemon, drops every registration for the
+                # masks and kind, whatever their keys.
+                for key in list(self.registrations):
+                        if key[0] in masks and key[1] == kind:
+                                del self.registrations[key]
+                self._compile()
+
+        def native(self):
+                """
+                @return a dictionary from (mask, kind, sync type) to the key set
+                to register natively.
+                """
+                result = {}
+                for key, sets in self.registrations.items():
+                        if [] in sets:
+                                result[key] = []
+                        else:
+                                merged = []
+                                for key_set in sets:
+                                        for k in key_set:
+                                                if k not in merged:
+                                                        merged.append(k)
+                                result[key] = merged
+                return result
+
+        def _compile(self):
+                table = {}
+                for (mask, kind, syncFlag), sets in self.registrations.items():
+                        keys = set()
+                        for key_set in sets:
+                                codes = [_keyCode(k) for k in key_set]
+                                if not codes or None in codes:
+                                        keys = None
+                                        break
+                                keys.update(codes)
+                        # As in the registry daemon, event type t matches the
+                        # kind bit 1 << t, and no bit at all matches any type.
+                        for bit in (1, 2, 4, 8):
+                                if kind and not kind & bit:
+                                        continue
+                                codes = table.get((mask, bit), frozenset())
+                                if codes is not None:
+                                        table[(mask, bit)] = None if keys is None else codes.union(keys)
+                self.table = table
+
+        def __call__(self, event):
+                try:
+                        codes = self.table[(event.modifiers & 0xFF, 1 << int(event.type))]
+                except KeyError:
+                        return False
+                if codes is not None and event.hw_code not in codes:
+                        return False
+                return self.client(event)
+
+#------------------------------------------------------------------------------
+
 class Registry(object):
         """
         Wraps the Accessibility.Registry to provide more Pythonic registration for
@@ -50,9 +342,9 @@ class Registry(object):
         reference to the Accessibility.Registry singleton. Doing so is harmless and
         has no point.
 
-        @@ivar async: Should event dispatch to local listeners be decoupled from event
-                receiving from the registry?
-        @@type async: boolean
+        @@ivar asynchronous: Should event dispatch to local listeners be decoupled
+                from event receiving from the registry?
+        @@type asynchronous: boolean
         @@ivar reg: Reference to the real, wrapped registry object
         @@type reg: Accessibility.Registry
         @@ivar dev: Reference to the device controller
@@ -111,20 +403,28 @@ class Registry(object):
 
                 self.has_implementations = True
 
-                self.async = False	# not fully supported yet
+                self.asynchronous = False	# not fully supported yet
+                # True while start runs the main loop, and so while events
+                # are dispatched. Caches that events keep up to date, such
+                # as the table headers of pyatspi.table, are only used then.
                 self.started = False
                 self.event_listeners = dict()
+                self.keystroke_listeners = dict()
+                self.key_bindings = dict()
+                self.event_trace = None
 
         def _set_default_registry (self):
                 self._set_registry (MAIN_LOOP_GLIB)
 
-        def start(self, async=False, gil=True):
+        def start(self, asynchronous=False, gil=True, **kwargs):
                 """
                 Enter the main loop to start receiving and dispatching events.
 
-                @@param async: Should event dispatch be asynchronous (decoupled) from 
-                        event receiving from the AT-SPI registry?
-                @@type async: boolean
+                @@param asynchronous: Should event dispatch be asynchronous
+                        (decoupled) from event receiving from the AT-SPI registry?
+                        Also accepted as 'async', its name before it became a
+                        keyword.
+                @@type asynchronous: boolean
                 @@param gil: Add an idle callback which releases the Python GIL for a few
                         milliseconds to allow other threads to run? Necessary if other threads
                         will be used in this process.
@@ -244,11 +544,67 @@ class Registry(object):
                 for name in names:
                         Atspi.EventListener.deregister(listener, name)
 
+        def startEventTrace(self, filename, names=("object",), chunkSize=4096,
+                            flushInterval=1000):
+                """
+                Starts writing the given events, by default all object events, to
+                an event trace that can be read with L{EventTraceReader}. A trace
+                already started is stopped first.
+
+                Events are written a chunk at a time, and at least every
+                flushInterval milliseconds while the main loop runs; the events
+                received since the last write are lost if the process dies.
+
+                @@param filename: Trace file to write; an existing file is replaced
+                @@type filename: string
+                @@param names: List of full or partial event names to trace
+                @@type names: list of string
+                @@param chunkSize: Number of events kept in memory before they are
+                        written
+                @@type chunkSize: integer
+                @@param flushInterval: Longest time, in milliseconds, events are kept
+                        in memory, or 0 to only write full chunks
+                @@type flushInterval: integer
+                @@return: The trace writer
+                @@rtype: L{EventTraceWriter}
+                """
+                from pyatspi.eventtrace import EventTraceWriter
+                self.stopEventTrace()
+                writer = EventTraceWriter(filename, chunkSize)
+                self.registerEventListener(writer, *names)
+                source = None
+                if flushInterval:
+                        def flush():
+                                writer.flush()
+                                return True
+                        source = GLib.timeout_add(flushInterval, flush)
+                self.event_trace = (writer, names, source)
+                return writer
+
+        def stopEventTrace(self):
+                """
+                Stops the event trace started by L{startEventTrace}, if any, and
+                writes the events it still holds.
+                """
+                trace = getattr(self, "event_trace", None)
+                if trace is None:
+                        return
+                writer, names, source = trace
+                self.event_trace = None
+                if source is not None:
+                        GLib.source_remove(source)
+                self.deregisterEventListener(writer, *names)
+                del self.event_listeners[writer]
+                writer.close()
+
         # -------------------------------------------------------------------------------
 
         # TODO: Remove this hack
         _KEY_PRESSED_EVENT=1
         _KEY_RELEASED_EVENT=2
+        # The type of key press events, KEY_PRESSED_EVENT in deviceevent; as a
+        # kind, it selects the events of that type, as 1 << type.
+        _KEY_PRESSED_EVENT_TYPE=0
 
         def makeSyncType(self, synchronous, preemptive, global_):
                 result = Atspi.KeyListenerSyncType.NOSYNC
@@ -266,6 +622,38 @@ class Registry(object):
                         result |= (1 << i)
                 return result
 
+        def _makeMasks(self, mask):
+                # The registry daemon compares the low eight bits of the
+                # modifiers; None stands for no modifier.
+                if not hasattr(mask, '__iter__'):
+                        mask = [mask]
+                masks = []
+                seen = set()
+                for m in mask:
+                        m = (m or 0) & 0xFF
+                        if m not in seen:
+                                seen.add(m)
+                                masks.append(m)
+                return masks
+
+        def _updateKeystrokeListener(self, listener, before, after):
+                # Only touches the native registrations that changed: a mask
+                # whose key set grew is registered again with the new set.
+                # Deregistering drops every registration of the listener for
+                # the mask and kind, whatever the sync type, so the other
+                # sync types kept for them are registered again.
+                dropped = set()
+                for key, key_set in before.items():
+                        if after.get(key) != key_set:
+                                mask, kind, syncFlag = key
+                                if (mask, kind) not in dropped:
+                                        Atspi.deregister_keystroke_listener(listener, key_set, mask, kind)
+                                        dropped.add((mask, kind))
+                for key, key_set in after.items():
+                        mask, kind, syncFlag = key
+                        if before.get(key) != key_set or (mask, kind) in dropped:
+                                Atspi.register_keystroke_listener(listener, key_set, mask, kind, syncFlag)
+
         def registerKeystrokeListener(self,
                                       client,
                                       key_set=[],
@@ -275,7 +663,11 @@ class Registry(object):
                                       preemptive=True,
                                       global_=False):
                 """
-                Registers a listener for key stroke events.
+                Registers a listener for key stroke events. Registrations of the
+                same client are merged: each distinct modifier mask is registered
+                once with the registry daemon, and events are checked against the
+                client's masks and keys with a single lookup before the client is
+                called.
 
                 @@param client: Callable to be invoked when the event occurs
                 @@type client: callable
@@ -305,20 +697,15 @@ class Registry(object):
                 if not self.has_implementations:
                         self._set_default_registry ()
                 try:
-                        listener = self.event_listeners[client]
-                except:
-                        listener = self.event_listeners[client] = Atspi.DeviceListener.new(self.eventWrapper, client)
-                syncFlag = self.makeSyncType(synchronous, preemptive, global_)
-                if hasattr(mask, '__iter__'):
-                        masks = mask
-                else:
-                        masks = [mask]
-                for m in masks:
-                        Atspi.register_keystroke_listener(listener,
-                                                          key_set,
-                                                          m,
-                                                          self.makeKind (kind),
-                                                          syncFlag)
+                        listener, keyFilter = self.keystroke_listeners[client]
+                except KeyError:
+                        keyFilter = _KeystrokeFilter(client)
+                        listener = Atspi.DeviceListener.new(self.eventWrapper, keyFilter)
+                        self.keystroke_listeners[client] = (listener, keyFilter)
+                before = keyFilter.native()
+                keyFilter.add(key_set, self._makeMasks(mask), self.makeKind(kind),
+                              self.makeSyncType(synchronous, preemptive, global_))
+                self._updateKeystrokeListener(listener, before, keyFilter.native())
 
         def deregisterKeystrokeListener(self,
                                         client,
@@ -348,20 +735,92 @@ class Registry(object):
                 if not self.has_implementations:
                         self._set_default_registry ()
                 try:
-                        listener = self.event_listeners[client]
-                except:
+                        listener, keyFilter = self.keystroke_listeners[client]
+                except KeyError:
                         return
 
-                if hasattr(mask, '__iter__'):
-                        masks = mask
-                else:
-                        masks = [mask]
-                for m in masks:
-                        Atspi.deregister_keystroke_listener (listener, key_set,
-                                m, self.makeKind(kind))
+                before = keyFilter.native()
+                keyFilter.remove(self._makeMasks(mask), self.makeKind(kind))
+                after = keyFilter.native()
+                self._updateKeystrokeListener(listener, before, after)
+                if not after:
+                        del self.keystroke_listeners[client]
 
                 # TODO: enqueueEvent, etc?
 
+        def registerKeyBindings(self,
+                                bindings,
+                                kind=(_KEY_PRESSED_EVENT_TYPE,),
+                                global_=False,
+                                deferred=True,
+                                timed=False):
+                """
+                Registers a table of key bindings as a synchronous, preemptive
+                keystroke listener. Events are consumed or passed on as soon as
+                they are looked up in the table; the handlers are run afterwards
+                from an idle callback of the GLib main loop.
+
+                Bindings added later with new modifier masks, or removed, require
+                registering the table again, which also deregisters the masks no
+                binding uses any more; the deferred and timed options given last
+                apply.
+
+                @@param bindings: The key bindings
+                @@type bindings: L{KeyBindings}
+                @@param kind: Kind of events to watch, KEY_PRESSED_EVENT or
+                        KEY_RELEASED_EVENT.
+                @@type kind: list
+                @@param global_: Should bindings apply even if an application not
+                        supporting AT-SPI is in the foreground?
+                @@type global_: boolean
+                @@param deferred: Should handlers run from the main loop? If not,
+                        they run before the decision is returned, as with
+                        L{registerKeystrokeListener}; useful without a GLib main loop.
+                @@type deferred: boolean
+                @@param timed: Should the worst decision time be recorded in
+                        bindings.worstDecisionTime?
+                @@type timed: boolean
+                """
+                if not self.has_implementations:
+                        self._set_default_registry ()
+                try:
+                        dispatcher = self.key_bindings[bindings]
+                        dispatcher.deferred = deferred
+                        dispatcher.timed = timed
+                except KeyError:
+                        dispatcher = _KeyBindingsDispatcher(bindings, deferred, timed)
+                        self.key_bindings[bindings] = dispatcher
+                masks = bindings.masks()
+                # masks of removed bindings would stay synchronous listeners
+                stale = [mask for mask in dispatcher.masks if mask not in masks]
+                if stale:
+                        self.deregisterKeystrokeListener(dispatcher, mask=stale, kind=kind)
+                dispatcher.masks = masks
+                if masks:
+                        self.registerKeystrokeListener(dispatcher,
+                                                       mask=masks,
+                                                       kind=kind,
+                                                       synchronous=True,
+                                                       preemptive=True,
+                                                       global_=global_)
+
+        def deregisterKeyBindings(self, bindings, kind=(_KEY_PRESSED_EVENT_TYPE,)):
+                """
+                Deregisters a table of key bindings.
+
+                @@param bindings: The key bindings
+                @@type bindings: L{KeyBindings}
+                @@param kind: Kind of events given when registering
+                @@type kind: list
+                """
+                if not self.has_implementations:
+                        self._set_default_registry ()
+                try:
+                        dispatcher = self.key_bindings.pop(bindings)
+                except KeyError:
+                        return
+                self.deregisterKeystrokeListener(dispatcher, mask=range(256), kind=kind)
+
         def generateKeyboardEvent(self, keycode, keysym, kind):
                 """
                 Generates a keyboard event. One of the keycode or the keysym parameters
@@ -382,6 +841,91 @@ class Registry(object):
                         keysym = ""
                 Atspi.generate_keyboard_event (keycode, keysym, kind)
 
+        def generateInputSequence(self, actions, callback=None, synchronous=False,
+                                  chunkSize=64):
+                """
+                Generates a sequence of keyboard and mouse events, with delays
+                between them. Actions are tuples:
+
+                  - ('key', keycode, keysym, kind): as L{generateKeyboardEvent}
+                  - ('string', text): types text, as a KEY_STRING event
+                  - ('mouse', x, y, name): as L{generateMouseEvent}
+                  - ('delay', milliseconds): waits before the next action
+
+                Strings typed without a delay in between, including KEY_STRING
+                'key' actions, are sent as one KEY_STRING event, split into
+                chunks of at most chunkSize characters.
+
+                By default the sequence is played from the GLib main loop, so
+                this returns at once, and delays do not block the caller.
+
+                @@param actions: The actions, in order
+                @@type actions: list of tuple
+                @@param callback: Called with no arguments once the last action
+                        has been played, or once an action has failed
+                @@type callback: callable
+                @@param synchronous: Should the sequence be played before
+                        returning, sleeping for the delays? Needed when no GLib
+                        main loop runs. The error of a failed action is raised
+                        after the callback has been called.
+                @@type synchronous: boolean
+                @@param chunkSize: Maximum length of a KEY_STRING event
+                @@type chunkSize: integer
+                @@return: The sequence, whose cancel() method stops it and whose
+                        error attribute holds the error of a failed action, or None
+                """
+                if not self.has_implementations:
+                        self._set_default_registry ()
+                steps = []
+                delay = 0
+                text = []
+
+                def flushText():
+                        string = "".join(text)
+                        del text[:]
+                        first = True
+                        for i in range(0, len(string), chunkSize):
+                                steps.append((delay if first else 0,
+                                              Atspi.generate_keyboard_event,
+                                              (0, string[i:i + chunkSize], Atspi.KeySynthType.STRING)))
+                                first = False
+
+                for action in actions:
+                        name = action[0]
+                        if name == 'delay':
+                                if text:
+                                        flushText()
+                                        delay = 0
+                                delay += int(action[1])
+                        elif name == 'string' or (name == 'key' and action[3] == Atspi.KeySynthType.STRING):
+                                text.append(action[1] if name == 'string' else action[2])
+                        else:
+                                if text:
+                                        flushText()
+                                        delay = 0
+                                if name == 'key':
+                                        keycode, keysym, kind = action[1:]
+                                        steps.append((delay, Atspi.generate_keyboard_event,
+                                                      (keycode, keysym if keysym is not None else "", kind)))
+                                elif name == 'mouse':
+                                        steps.append((delay, Atspi.generate_mouse_event, tuple(action[1:])))
+                                else:
+                                        raise ValueError("unknown input action %r" % (name,))
+                                delay = 0
+                if text:
+                        flushText()
+                        delay = 0
+                if delay:
+                        # a trailing delay postpones the callback
+                        steps.append((delay, lambda: None, ()))
+
+                sequence = _InputSequence(steps, callback)
+                if synchronous:
+                        sequence.play()
+                else:
+                        sequence.start()
+                return sequence
+
         def generateMouseEvent(self, x, y, name):
                 """
                 Generates a mouse event at the given absolute x and y coordinate. The kind
@@ -0,0 +1,363 @@
+#This library is free software; you can redistribute it and/or
+#modify it under the terms of the GNU Lesser General Public
+#License version 2 as published by the Free Software Foundation.
+
+#This program is distributed in the hope that it will be useful,
+#but WITHOUT ANY WARRANTY; without even the implied warranty of
+#MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#GNU General Public License for more details.
+#You should have received a copy of the GNU Lesser General Public License
+#along with this program; if not, write to the Free Software
+#Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+from gi.repository import Atspi
+from pyatspi.state import STATE_SHOWING
+from pyatspi.component import XY_SCREEN, getExtentsBatch
+from pyatspi.utils import BoundingBox
+
+__all__ = [
+           "SpatialIndex",
+           "computeVisibleRegions",
+          ]
+
+#------------------------------------------------------------------------------
+
+_spatialIndexEvents = (
+        "object:bounds-changed",
+        "object:children-changed",
+        "object:state-changed:showing",
+)
+
+class SpatialIndex(object):
+        """
+        A uniform grid over the extents of the showing components below a
+        root accessible, usually a window. Once built, the deepest accessible
+        at a point is found locally, instead of calling getAccessibleAtPoint
+        on each level of the tree.
+
+        Call start() to keep the index up to date: bounds changes update
+        the extents of the object concerned, and changes to the children or
+        to the showing state of the root or of indexed objects cause a
+        rebuild on the next query. Events about other objects are ignored.
+        """
+
+        def __init__(self, root, coordType=XY_SCREEN, cellSize=64):
+                """
+                @param : root
+                the accessible whose showing descendants are indexed.
+                @param : coordType
+                the coordinate system of the points given to
+                getAccessibleAtPoint.
+                @param : cellSize
+                the width and height of the grid cells, in pixels.
+                """
+                self.root = root
+                self.coordType = coordType
+                self.cellSize = cellSize
+                self._entries = []
+                self._entryByAccessible = {}
+                self._grid = {}
+                self._application = None
+                self._dirty = True
+
+        def start(self):
+                """
+                Starts following bounds, children and showing state changes.
+                """
+                from pyatspi.Accessibility import Registry
+                Registry.registerEventListener(self._onEvent, *_spatialIndexEvents)
+
+        def stop(self):
+                """
+                Stops following changes.
+                """
+                from pyatspi.Accessibility import Registry
+                Registry.deregisterEventListener(self._onEvent, *_spatialIndexEvents)
+
+        def _onEvent(self, event):
+                if self._dirty:
+                        return
+                source = event.source
+                if event.type.startswith("object:bounds-changed"):
+                        entry = self._entryByAccessible.get(source)
+                        if entry is not None:
+                                self._removeFromGrid(entry)
+                                entry[1:5] = getExtentsBatch((source,), self.coordType)
+                                self._addToGrid(entry)
+                elif source in self._entryByAccessible or source == self.root:
+                        self._dirty = True
+                elif event.type.startswith("object:state-changed:showing"):
+                        # An object that was not showing is not indexed; it
+                        # matters if its parent is. Events from other
+                        # applications are dropped before asking.
+                        try:
+                                if source.getApplication() != self._application:
+                                        return
+                                parent = source.parent
+                        except Exception:
+                                return
+                        if parent in self._entryByAccessible or parent == self.root:
+                                self._dirty = True
+
+        def invalidate(self):
+                """
+                Drops the index; it is rebuilt on the next query.
+                """
+                self._dirty = True
+
+        def rebuild(self):
+                """
+                Collects the showing components below the root, then reads all
+                their extents in one pass and fills the grid.
+                """
+                try:
+                        self._application = self.root.getApplication()
+                except Exception:
+                        self._application = None
+                accessibles = []
+                depths = []
+                stack = [(self.root, 0)]
+                while stack:
+                        accessible, depth = stack.pop()
+                        try:
+                                if not accessible.getState().contains(STATE_SHOWING):
+                                        continue
+                                if Atspi.Accessible.get_component_iface(accessible):
+                                        accessibles.append(accessible)
+                                        depths.append(depth)
+                                children = [accessible.getChildAtIndex(i)
+                                            for i in range(accessible.childCount)]
+                        except Exception:
+                                continue
+                        # Pushed in reverse, so that children are visited in
+                        # painting order.
+                        for child in reversed(children):
+                                if child is not None:
+                                        stack.append((child, depth + 1))
+
+                extents = getExtentsBatch(accessibles, self.coordType)
+                self._entries = []
+                self._entryByAccessible = {}
+                self._grid = {}
+                for order, accessible in enumerate(accessibles):
+                        entry = [accessible] + extents[4 * order:4 * order + 4].tolist() + [(depths[order], order)]
+                        self._entries.append(entry)
+                        self._entryByAccessible[accessible] = entry
+                        self._addToGrid(entry)
+                self._dirty = False
+
+        def _cells(self, entry):
+                x, y, width, height = entry[1:5]
+                if width <= 0 or height <= 0:
+                        return ()
+                size = self.cellSize
+                return [(cx, cy)
+                        for cx in range(x // size, (x + width - 1) // size + 1)
+                        for cy in range(y // size, (y + height - 1) // size + 1)]
+
+        def _addToGrid(self, entry):
+                for cell in self._cells(entry):
+                        self._grid.setdefault(cell, []).append(entry)
+
+        def _removeFromGrid(self, entry):
+                for cell in self._cells(entry):
+                        entries = self._grid.get(cell, ())
+                        for i, other in enumerate(entries):
+                                if other is entry:
+                                        del entries[i]
+                                        break
+
+        def getAccessibleAtPoint(self, x, y):
+                """
+                Finds the deepest showing component containing a point; among
+                components at the same depth, the last one in tree order wins.
+                @return the accessible, or None if no component contains the
+                point.
+                """
+                if self._dirty:
+                        self.rebuild()
+                size = self.cellSize
+                best = None
+                for entry in self._grid.get((x // size, y // size), ()):
+                        ex, ey, width, height = entry[1:5]
+                        if ex <= x < ex + width and ey <= y < ey + height:
+                                if best is None or entry[5] > best[5]:
+                                        best = entry
+                return best[0] if best is not None else None
+
+        def __len__(self):
+                if self._dirty:
+                        self.rebuild()
+                return len(self._entries)
+
+#------------------------------------------------------------------------------
+
+# Size of the grid cells used to find the components overlapping a
+# component in computeVisibleRegions.
+_OCCLUSION_CELL_SIZE = 128
+
+def _collectPaintOrder(window, coordType):
+        # Returns the showing components below window in painting order,
+        # with their extents as (x1, y1, x2, y2) and the paint index just
+        # past each component's descendants. Siblings are painted by layer,
+        # then MDI z-order, then index; a parent is painted before its
+        # children.
+        nodes = []
+        children = {}
+        stack = [(window, None, 0)]
+        while stack:
+                accessible, parent, index = stack.pop()
+                try:
+                        if not accessible.getState().contains(STATE_SHOWING):
+                                continue
+                        isComponent = bool(Atspi.Accessible.get_component_iface(accessible))
+                        count = accessible.childCount
+                        kids = [accessible.getChildAtIndex(i) for i in range(count)]
+                except Exception:
+                        continue
+                node = len(nodes)
+                nodes.append((accessible, isComponent, index))
+                children.setdefault(parent, []).append(node)
+                for i in range(len(kids) - 1, -1, -1):
+                        if kids[i] is not None:
+                                stack.append((kids[i], node, i))
+
+        components = [accessible for accessible, isComponent, index in nodes if isComponent]
+        extents = getExtentsBatch(components, coordType)
+        keys = []
+        for accessible, isComponent, index in nodes:
+                if isComponent:
+                        try:
+                                keys.append((Atspi.Component.get_layer(accessible),
+                                             Atspi.Component.get_mdi_z_order(accessible),
+                                             index))
+                        except Exception:
+                                keys.append((0, 0, index))
+                else:
+                        keys.append((0, 0, index))
+        boxes = {}
+        offset = 0
+        for node, (accessible, isComponent, index) in enumerate(nodes):
+                if isComponent:
+                        x, y, width, height = extents[offset:offset + 4]
+                        boxes[node] = (x, y, x + width, y + height)
+                        offset += 4
+
+        # Walked with an explicit stack, as deep trees would exceed the
+        # recursion limit. An entry with a position closes the component
+        # painted there once its descendants have been painted.
+        order = []
+        ends = []
+        stack = [(root, None) for root in reversed(children.get(None, ()))]
+        while stack:
+                node, position = stack.pop()
+                if position is not None:
+                        ends[position] = len(order)
+                        continue
+                if node in boxes:
+                        stack.append((node, len(order)))
+                        order.append(node)
+                        ends.append(None)
+                kids = sorted(children.get(node, ()), key=keys.__getitem__)
+                for child in reversed(kids):
+                        stack.append((child, None))
+        return ([nodes[node][0] for node in order],
+                [boxes[node] for node in order],
+                ends)
+
+def _subtractBoxes(box, occluders):
+        # Sweeps the box from top to bottom across the horizontal bands
+        # delimited by the occluder edges; in each band the free parts are
+        # the gaps between the occluders' merged x-intervals. Bands with the
+        # same free parts are merged into one rectangle.
+        left, top, right, bottom = box
+        ys = set((top, bottom))
+        for occluder in occluders:
+                ys.add(occluder[1])
+                ys.add(occluder[3])
+        ys = sorted(ys)
+        regions = []
+        previous = ()
+        start = top
+        for i in range(len(ys) - 1):
+                y0, y1 = ys[i], ys[i + 1]
+                spans = sorted((o[0], o[2]) for o in occluders if o[1] <= y0 and y1 <= o[3])
+                free = []
+                x = left
+                for x1, x2 in spans:
+                        if x1 > x:
+                                free.append((x, x1))
+                        x = max(x, x2)
+                if x < right:
+                        free.append((x, right))
+                free = tuple(free)
+                if free != previous:
+                        for x1, x2 in previous:
+                                regions.append(BoundingBox(x1, start, x2 - x1, y0 - start))
+                        previous = free
+                        start = y0
+        for x1, x2 in previous:
+                regions.append(BoundingBox(x1, start, x2 - x1, bottom - start))
+        return regions
+
+def computeVisibleRegions(window, coordType=XY_SCREEN):
+        """
+        Computes which parts of the showing components below a window are
+        not covered by other components. Components are stacked as they
+        are painted: siblings by layer, then MDI z-order, then index, each
+        above its parent. A component is not considered covered by its own
+        descendants. All regions are clipped to the window.
+
+        @param window: The window whose components are examined
+        @type window: Accessibility.Accessible
+        @param coordType: Coordinate system of the regions
+        @type coordType: CoordType
+        @return: A (component, regions) pair for each showing component, in
+                painting order, where regions is a list of disjoint BoundingBox
+                objects, empty if the component is entirely covered
+        @rtype: list
+        """
+        accessibles, boxes, ends = _collectPaintOrder(window, coordType)
+        if not boxes:
+                return []
+        x, y, width, height = getExtentsBatch((window,), coordType)
+        windowBox = (x, y, x + width, y + height)
+
+        clipped = []
+        for x1, y1, x2, y2 in boxes:
+                clipped.append((max(x1, windowBox[0]), max(y1, windowBox[1]),
+                                min(x2, windowBox[2]), min(y2, windowBox[3])))
+
+        size = _OCCLUSION_CELL_SIZE
+        grid = {}
+        def cells(box):
+                return [(cx, cy)
+                        for cx in range(box[0] // size, (box[2] - 1) // size + 1)
+                        for cy in range(box[1] // size, (box[3] - 1) // size + 1)]
+        for position, box in enumerate(clipped):
+                if box[0] < box[2] and box[1] < box[3]:
+                        for cell in cells(box):
+                                grid.setdefault(cell, []).append(position)
+
+        result = []
+        for position, box in enumerate(clipped):
+                if box[0] >= box[2] or box[1] >= box[3]:
+                        result.append((accessibles[position], []))
+                        continue
+                end = ends[position]
+                candidates = set()
+                for cell in cells(box):
+                        for other in grid.get(cell, ()):
+                                if other >= end:
+                                        candidates.add(other)
+                occluders = []
+                for other in candidates:
+                        o = clipped[other]
+                        x1, y1 = max(o[0], box[0]), max(o[1], box[1])
+                        x2, y2 = min(o[2], box[2]), min(o[3], box[3])
+                        if x1 < x2 and y1 < y2:
+                                occluders.append((x1, y1, x2, y2))
+                result.append((accessibles[position], _subtractBoxes(box, occluders)))
+        return result
+
+#END----------------------------------------------------------------------------
@@ -124,12 +124,53 @@ STATE_VISITED = StateType(40)
 
 #------------------------------------------------------------------------------
 
-# Build a dictionary mapping state values to names based on the prefix of the enum constants.
-
-STATE_VALUE_TO_NAME = dict(((value, name[6:].lower().replace('_', ' '))
-                            for name, value
-                            in globals().items() 
-                            if name.startswith('STATE_')))
+STATE_VALUE_TO_NAME = {
+        STATE_INVALID:'invalid',
+        STATE_ACTIVE:'active',
+        STATE_ARMED:'armed',
+        STATE_BUSY:'busy',
+        STATE_CHECKED:'checked',
+        STATE_COLLAPSED:'collapsed',
+        STATE_DEFUNCT:'defunct',
+        STATE_EDITABLE:'editable',
+        STATE_ENABLED:'enabled',
+        STATE_EXPANDABLE:'expandable',
+        STATE_EXPANDED:'expanded',
+        STATE_FOCUSABLE:'focusable',
+        STATE_FOCUSED:'focused',
+        STATE_HAS_TOOLTIP:'has tooltip',
+        STATE_HORIZONTAL:'horizontal',
+        STATE_ICONIFIED:'iconified',
+        STATE_MODAL:'modal',
+        STATE_MULTI_LINE:'multi line',
+        STATE_MULTISELECTABLE:'multiselectable',
+        STATE_OPAQUE:'opaque',
+        STATE_PRESSED:'pressed',
+        STATE_RESIZABLE:'resizable',
+        STATE_SELECTABLE:'selectable',
+        STATE_SELECTED:'selected',
+        STATE_SENSITIVE:'sensitive',
+        STATE_SHOWING:'showing',
+        STATE_SINGLE_LINE:'single line',
+        STATE_STALE:'stale',
+        STATE_TRANSIENT:'transient',
+        STATE_VERTICAL:'vertical',
+        STATE_VISIBLE:'visible',
+        STATE_MANAGES_DESCENDANTS:'manages descendants',
+        STATE_INDETERMINATE:'indeterminate',
+        STATE_REQUIRED:'required',
+        STATE_TRUNCATED:'truncated',
+        STATE_ANIMATED:'animated',
+        STATE_INVALID_ENTRY:'invalid entry',
+        STATE_SUPPORTS_AUTOCOMPLETION:'supports autocompletion',
+        STATE_SELECTABLE_TEXT:'selectable text',
+        STATE_IS_DEFAULT:'is default',
+        STATE_VISITED:'visited',
+        STATE_CHECKABLE:'checkable',
+        STATE_HAS_POPUP:'has popup',
+        STATE_READ_ONLY:'read only',
+        STATE_LAST_DEFINED:'last defined',
+}
 
 #------------------------------------------------------------------------------
 
@@ -151,3 +192,172 @@ StateSet.isEmpty = StateSet.is_empty
 StateSet.raw = lambda x: x
 StateSet.unref = lambda x: None
 StateSet.__init__ = stateset_init
+
+#------------------------------------------------------------------------------
+
+def _stateBits(states):
+        if isinstance(states, StateMask):
+                return states.bits
+        if isinstance(states, int):
+                return 1 << states
+        bits = 0
+        for state in states:
+                bits |= 1 << state
+        return bits
+
+class StateMask(object):
+        """
+        An immutable set of states held in a single integer, one bit per
+        StateType, the same layout as the states field of an Atspi.StateSet.
+        Membership tests and set operations are single integer operations,
+        so a StateMask is meant for testing states repeatedly, for instance
+        in event filters, rather than calling contains on a StateSet.
+        """
+
+        __slots__ = ("bits",)
+
+        def __init__(self, *states):
+                """
+                @param : states
+                the states in the set.
+                """
+                bits = 0
+                for state in states:
+                        bits |= 1 << state
+                object.__setattr__(self, "bits", bits)
+
+        @classmethod
+        def fromBits(cls, bits):
+                """
+                @return a StateMask whose bit n is set when state n is in the
+                set.
+                """
+                mask = object.__new__(cls)
+                object.__setattr__(mask, "bits", bits)
+                return mask
+
+        @classmethod
+        def fromStateSet(cls, stateSet):
+                """
+                @return a StateMask holding the states of an Atspi.StateSet.
+                """
+                return cls.fromBits(stateSet.states)
+
+        def toStateSet(self):
+                """
+                @return a new Atspi.StateSet holding the same states.
+                """
+                return Atspi.StateSet.new(self.getStates())
+
+        def __setattr__(self, name, value):
+                raise AttributeError("StateMask is immutable")
+
+        def contains(self, state):
+                return (self.bits >> state) & 1 == 1
+
+        __contains__ = contains
+
+        def containsAll(self, states):
+                """
+                @param : states
+                a StateMask, or an iterable of states.
+                @return True if every state given is in the set.
+                """
+                bits = _stateBits(states)
+                return self.bits & bits == bits
+
+        def containsAny(self, states):
+                """
+                @param : states
+                a StateMask, or an iterable of states.
+                @return True if at least one of the states given is in the set.
+                """
+                return self.bits & _stateBits(states) != 0
+
+        def add(self, *states):
+                """
+                @return a StateMask holding these states and the ones given.
+                """
+                return StateMask.fromBits(self.bits | _stateBits(states))
+
+        def remove(self, *states):
+                """
+                @return a StateMask holding these states but the ones given.
+                """
+                return StateMask.fromBits(self.bits & ~_stateBits(states))
+
+        def __or__(self, other):
+                return StateMask.fromBits(self.bits | _stateBits(other))
+
+        def __and__(self, other):
+                return StateMask.fromBits(self.bits & _stateBits(other))
+
+        def __sub__(self, other):
+                return StateMask.fromBits(self.bits & ~_stateBits(other))
+
+        def __xor__(self, other):
+                return StateMask.fromBits(self.bits ^ _stateBits(other))
+
+        __ror__ = __or__
+        __rand__ = __and__
+        __rxor__ = __xor__
+
+        def __eq__(self, other):
+                if isinstance(other, StateMask):
+                        return self.bits == other.bits
+                return NotImplemented
+
+        def __ne__(self, other):
+                if isinstance(other, StateMask):
+                        return self.bits != other.bits
+                return NotImplemented
+
+        def __hash__(self):
+                return hash(self.bits)
+
+        def isEmpty(self):
+                return self.bits == 0
+
+        def __bool__(self):
+                return self.bits != 0
+
+        __nonzero__ = __bool__
+
+        def __len__(self):
+                return bin(self.bits).count("1")
+
+        def getStates(self):
+                """
+                @return the states in the set, as a list of StateType.
+                """
+                states = []
+                bits = self.bits
+                state = 0
+                while bits:
+                        if bits & 1:
+                                states.append(StateType(state))
+                        bits >>= 1
+                        state += 1
+                return states
+
+        def __iter__(self):
+                return iter(self.getStates())
+
+        def __reduce__(self):
+                return (_stateMaskFromBits, (self.bits,))
+
+        def __repr__(self):
+                return "StateMask(%s)" % ", ".join(str(state) for state in self.getStates())
+
+def _stateMaskFromBits(bits):
+        return StateMask.fromBits(bits)
+
+# Masks for common checks
+MASK_EMPTY = StateMask()
+MASK_SHOWING_VISIBLE = StateMask(STATE_SHOWING, STATE_VISIBLE)
+MASK_SHOWING_VISIBLE_SENSITIVE = StateMask(STATE_SHOWING, STATE_VISIBLE, STATE_SENSITIVE)
+MASK_FOCUSABLE_SENSITIVE = StateMask(STATE_FOCUSABLE, STATE_SENSITIVE)
+MASK_SELECTABLE_SELECTED = StateMask(STATE_SELECTABLE, STATE_SELECTED)
+MASK_GONE = StateMask(STATE_DEFUNCT, STATE_STALE)
+
+StateSet.getMask = StateMask.fromStateSet
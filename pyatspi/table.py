@@ -13,12 +13,17 @@
 #along with this program; if not, write to the Free Software
 #Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 
+import weakref
+
 from gi.repository import Atspi
 from pyatspi.utils import *
 from pyatspi.interface import *
+from pyatspi.component import XY_SCREEN
 
 __all__ = [
            "Table",
+           "TableGridCell",
+           "TableViewport",
           ]
 
 #------------------------------------------------------------------------------
@@ -59,6 +64,25 @@ class Table(interface):
                 """
                 return Atspi.Table.add_row_selection(self.obj, row)
 
+        def deselectRowRange(self, start, stop):
+                """
+                De-selects the rows from start to stop (exclusive). The current
+                row selection is read once, and only the rows of the range
+                which are selected are de-selected.
+                @param : start
+                the first row to de-select.
+                @param : stop
+                the row after the last row to de-select.
+                @return True if all the selected rows of the range were
+                de-selected, False otherwise.
+                """
+                start, stop = _gridRange((start, stop), self.nRows)
+                result = True
+                for row in sorted(self.getSelectedRows()):
+                        if start <= row < stop:
+                                result = Atspi.Table.remove_row_selection(self.obj, row) and result
+                return result
+
         def getAccessibleAt(self, row, column):
                 """
                 Get the table cell at the specified row and column indices. 
@@ -105,7 +129,9 @@ class Table(interface):
                 @return a long integer indicating the number of columns spanned
                 by the specified cell.
                 """
-                return Atspi.Table.get_column_extent_at(self.obj, row, column)
+                tableMap = _getTableMap(self.obj)
+                return tableMap.lookup(tableMap.columnExtents, (row, column),
+                                       Atspi.Table.get_column_extent_at, self.obj, row, column)
 
         def getColumnHeader(self, index):
                 """
@@ -117,7 +143,9 @@ class Table(interface):
                 @return an Accessible representatin of the specified table column,
                 if available.
                 """
-                return Atspi.Table.get_column_header(self.obj, index)
+                tableMap = _getTableMap(self.obj)
+                return tableMap.lookup(tableMap.columnHeaders, index,
+                                       Atspi.Table.get_column_header, self.obj, index)
 
         def getIndexAt(self, row, column):
                 """
@@ -181,6 +209,74 @@ class Table(interface):
                 """
                 return Atspi.Table.get_row_column_extents_at_index(self.obj, index)
 
+        def getGridSnapshot(self, rows=None, columns=None, fields=('name', 'text', 'states')):
+                """
+                Reads a rectangular block of cells at once. The cells of each
+                row are found by enumerating the table children between the
+                first and the last cell of that row within the block, so each
+                cell costs a single extents query plus the requested fields,
+                instead of separate getAccessibleAt, getRowExtentAt and
+                getColumnExtentAt calls. Cells whose child index lies outside
+                those ranges are looked up individually, as are the cells of
+                rows whose range is wider than the block, as happens when the
+                children are not in row-major order.
+                @param : rows
+                a (start, stop) pair or a range of consecutive rows, or None
+                for all rows.
+                @param : columns
+                a (start, stop) pair or a range of consecutive columns, or None
+                for all columns.
+                @param : fields
+                the cell properties to read: any of 'name', 'description',
+                'role', 'states' and 'text' (None for cells without Text).
+                @return a list of rows, each a list of TableGridCell objects (or
+                None where there is no cell). A cell spanning several rows or
+                columns is the same object at every position it covers.
+                """
+                rowStart, rowStop = _gridRange(rows, self.nRows)
+                columnStart, columnStop = _gridRange(columns, self.nColumns)
+                grid = [[None] * (columnStop - columnStart) for row in range(rowStart, rowStop)]
+                if rowStart >= rowStop or columnStart >= columnStop:
+                        return grid
+                block = (rowStart, rowStop, columnStart, columnStop)
+                width = columnStop - columnStart
+                placed = set()
+                for row in range(rowStart, rowStop):
+                        first = self.getIndexAt(row, columnStart)
+                        last = self.getIndexAt(row, columnStop - 1)
+                        # children not in row-major order: look cells up one by one
+                        if first < 0 or last < first or last - first >= width:
+                                continue
+                        for index in range(first, last + 1):
+                                if index not in placed:
+                                        placed.add(index)
+                                        self._placeGridCell(grid, block, index, fields)
+                for row in range(rowStart, rowStop):
+                        for column in range(columnStart, columnStop):
+                                if grid[row - rowStart][column - columnStart] is None:
+                                        index = self.getIndexAt(row, column)
+                                        if index >= 0:
+                                                self._placeGridCell(grid, block, index, fields)
+                return grid
+
+        def _placeGridCell(self, grid, block, index, fields):
+                rowStart, rowStop, columnStart, columnStop = block
+                ok, row, column, rowSpan, columnSpan, selected = self.getRowColumnExtentsAtIndex(index)
+                if not ok:
+                        return
+                rowSpan = max(rowSpan, 1)
+                columnSpan = max(columnSpan, 1)
+                top, bottom = max(row, rowStart), min(row + rowSpan, rowStop)
+                left, right = max(column, columnStart), min(column + columnSpan, columnStop)
+                if top >= bottom or left >= right:
+                        return
+                cell = TableGridCell(Atspi.Accessible.get_child_at_index(self.obj, index),
+                                     row, column, rowSpan, columnSpan, selected, fields)
+                for r in range(top, bottom):
+                        gridRow = grid[r - rowStart]
+                        for c in range(left, right):
+                                gridRow[c - columnStart] = cell
+
         def getRowDescription(self, index):
                 """
                 Get a text description of a particular table row. This differs
@@ -204,7 +300,9 @@ class Table(interface):
                 @return a long integer indicating the number of rows spanned
                 by the specified cell.
                 """
-                return Atspi.Table.get_row_extent_at(self.obj, row, column)
+                tableMap = _getTableMap(self.obj)
+                return tableMap.lookup(tableMap.rowExtents, (row, column),
+                                       Atspi.Table.get_row_extent_at, self.obj, row, column)
 
         def getRowHeader(self, row):
                 """
@@ -215,7 +313,9 @@ class Table(interface):
                 @return an Accessible representatin of the specified table row,
                 if available.
                 """
-                return Atspi.Table.get_row_header(self.obj, row)
+                tableMap = _getTableMap(self.obj)
+                return tableMap.lookup(tableMap.rowHeaders, row,
+                                       Atspi.Table.get_row_header, self.obj, row)
 
         def getSelectedColumns(self):
                 """
@@ -233,6 +333,17 @@ class Table(interface):
                 """
                 return Atspi.Table.get_selected_rows(self.obj)
 
+        def getSelectionBitmap(self):
+                """
+                Reads the row and column selection at once, instead of
+                calling isSelected for each cell. A cell is selected if its
+                row or its column is.
+                @return a (rows, columns) pair of bytearrays, where bit i % 8 of
+                byte i // 8 is set if row (or column) i is selected.
+                """
+                return (_selectionBitmap(self.getSelectedRows(), self.nRows),
+                        _selectionBitmap(self.getSelectedColumns(), self.nColumns))
+
         def isColumnSelected(self, column):
                 """
                 Determine whether a table column is selected. 
@@ -285,6 +396,26 @@ class Table(interface):
                 """
                 return Atspi.Table.remove_row_selection(self.obj, row)
 
+        def selectRowRange(self, start, stop):
+                """
+                Selects the rows from start to stop (exclusive). The current
+                row selection is read once, and rows of the range which are
+                already selected are skipped.
+                @param : start
+                the first row to select.
+                @param : stop
+                the row after the last row to select.
+                @return True if all the rows of the range are now selected,
+                False otherwise.
+                """
+                start, stop = _gridRange((start, stop), self.nRows)
+                selected = set(self.getSelectedRows())
+                result = True
+                for row in range(start, stop):
+                        if row not in selected:
+                                result = Atspi.Table.add_row_selection(self.obj, row) and result
+                return result
+
         def get_caption(self):
                 return Atspi.Table.get_caption(self.obj)
         _captionDoc = \
@@ -342,4 +473,339 @@ class Table(interface):
                 """
         summary = property(fget=get_summary, doc=_summaryDoc)
 
+#------------------------------------------------------------------------------
+
+_tableModelEvents = (
+        "object:model-changed",
+        "object:row-inserted",
+        "object:row-deleted",
+        "object:row-reordered",
+        "object:column-inserted",
+        "object:column-deleted",
+        "object:column-reordered",
+)
+
+# Events after which the cached headers of a table are dropped, besides
+# the model events above.
+_tableHeaderEvents = (
+        "object:property-change:accessible-table-row-header",
+        "object:property-change:accessible-table-column-header",
+        "object:property-change:accessible-table-row-description",
+        "object:property-change:accessible-table-column-description",
+)
+
+class _TableMap(object):
+        """
+        Headers and spans of a table, filled in as they are queried and
+        dropped when the table model or its headers change. The header
+        cells of a cell are keyed on the cell accessible itself, so that
+        no remote call is needed to look them up.
+        """
+
+        def __init__(self):
+                self.columnHeaders = {}
+                self.rowHeaders = {}
+                self.columnExtents = {}
+                self.rowExtents = {}
+                self.columnHeaderCells = {}
+                self.rowHeaderCells = {}
+
+        def lookup(self, cache, key, fetch, *args):
+                try:
+                        return cache[key]
+                except KeyError:
+                        value = cache[key] = fetch(*args)
+                        return value
+
+_tableMaps = weakref.WeakKeyDictionary()
+_tableMapsListening = [False]
+
+def _getTableMap(accessible):
+        # The maps are only kept up to date by events, which are only
+        # dispatched while the registry's main loop runs. Without it, an
+        # empty map that is not kept is returned, so nothing is cached.
+        from pyatspi.Accessibility import Registry
+        if not getattr(Registry, "started", False):
+                if _tableMaps:
+                        _tableMaps.clear()
+                return _TableMap()
+        try:
+                return _tableMaps[accessible]
+        except KeyError:
+                pass
+        if not _tableMapsListening[0]:
+                Registry.registerEventListener(_onTableModelChanged,
+                                               *(_tableModelEvents + _tableHeaderEvents))
+                _tableMapsListening[0] = True
+        tableMap = _tableMaps[accessible] = _TableMap()
+        return tableMap
+
+def _onTableModelChanged(event):
+        _tableMaps.pop(event.source, None)
+
+def _clearTableMaps():
+        _tableMaps.clear()
+
+#------------------------------------------------------------------------------
+
+def _gridRange(value, count):
+        if value is None:
+                return (0, count)
+        if isinstance(value, tuple):
+                start, stop = value
+        else:
+                value = list(value)
+                if not value:
+                        return (0, 0)
+                start, stop = value[0], value[-1] + 1
+        return (max(start, 0), min(stop, count))
+
+def _selectionBitmap(indices, count):
+        bitmap = bytearray((count + 7) // 8)
+        for i in indices:
+                if 0 <= i < count:
+                        bitmap[i >> 3] |= 1 << (i & 7)
+        return bitmap
+
+def _getCellText(accessible):
+        try:
+                return accessible.queryText().getText(0, -1)
+        except NotImplementedError:
+                return None
+
+_gridFieldGetters = {
+        'name': lambda accessible: accessible.name,
+        'description': lambda accessible: accessible.description,
+        'role': lambda accessible: accessible.getRole(),
+        'states': lambda accessible: accessible.getState(),
+        'text': _getCellText,
+}
+
+class TableGridCell(object):
+        """
+        A cell of a snapshot returned by Table.getGridSnapshot. Besides the
+        position and span of the cell, it has an attribute for each of the
+        requested fields.
+        """
+
+        def __init__(self, accessible, row, column, rowSpan, columnSpan, selected, fields):
+                self.accessible = accessible
+                self.row = row
+                self.column = column
+                self.rowSpan = rowSpan
+                self.columnSpan = columnSpan
+                self.selected = selected
+                for field in fields:
+                        setattr(self, field, _gridFieldGetters[field](accessible))
+
+        def __repr__(self):
+                return '<TableGridCell (%d, %d) span %dx%d>' % \
+                       (self.row, self.column, self.rowSpan, self.columnSpan)
+
+#------------------------------------------------------------------------------
+
+_viewportScrollEvents = (
+        "object:visible-data-changed",
+        "object:bounds-changed",
+)
+
+# Number of points tried along each diagonal of the table when looking for
+# the first and last visible cells, so that headers and empty areas in the
+# corners of the table are skipped.
+_VIEWPORT_PROBES = 8
+
+class TableViewport(object):
+        """
+        Keeps the cells of the visible part of a table, plus a margin of
+        rows and columns around it, so that moving around a table costs the
+        same whatever the number of rows it has. The visible window is found
+        by hit testing the table's extents; once start() has been called, the
+        window follows scrolling and is dropped when the table model changes.
+        """
+
+        def __init__(self, table, margin=20, fields=('name', 'text', 'states')):
+                """
+                @param : table
+                the Table, or an accessible implementing it.
+                @param : margin
+                the number of rows and columns cached beyond each side of
+                the visible window.
+                @param : fields
+                the cell properties to cache, as for Table.getGridSnapshot.
+                """
+                if not isinstance(table, Table):
+                        table = table.queryTable()
+                self.table = table
+                self.margin = margin
+                self.fields = fields
+                self.visible = None
+                self._window = None
+                self._rows = []
+
+        def start(self):
+                """
+                Starts following scroll and model change events of the table.
+                """
+                from pyatspi.Accessibility import Registry
+                Registry.registerEventListener(self._onEvent,
+                                               *(_viewportScrollEvents + _tableModelEvents))
+
+        def stop(self):
+                """
+                Stops following the events of the table.
+                """
+                from pyatspi.Accessibility import Registry
+                Registry.deregisterEventListener(self._onEvent,
+                                                 *(_viewportScrollEvents + _tableModelEvents))
+
+        def _onEvent(self, event):
+                if event.source != self.table.obj:
+                        return
+                if event.type in _tableModelEvents:
+                        self.invalidate()
+                self.refresh()
+
+        def invalidate(self):
+                """
+                Drops the cached cells.
+                """
+                self.visible = None
+                self._window = None
+                self._rows = []
+
+        def getVisibleRange(self):
+                """
+                Finds the rows and columns currently shown by the table.
+                @return a (rowStart, rowStop, columnStart, columnStop) tuple, or
+                None if no cell is showing.
+                """
+                component = self.table.queryComponent()
+                x, y, width, height = component.getExtents(XY_SCREEN)
+                if width <= 0 or height <= 0:
+                        return None
+                first = self._findCell(component, x, y, width, height, 1)
+                last = self._findCell(component, x + width - 1, y + height - 1, width, height, -1)
+                if first is None or last is None:
+                        return None
+                row, column = last
+                rowStop = row + max(self.table.getRowExtentAt(row, column), 1)
+                columnStop = column + max(self.table.getColumnExtentAt(row, column), 1)
+                return (first[0], rowStop, first[1], columnStop)
+
+        def _findCell(self, component, x, y, width, height, direction):
+                # Walks along the diagonal from the corner (x, y) towards the
+                # middle of the table; once a cell is hit, bisects back to the
+                # first cell hit along the diagonal.
+                def probe(step):
+                        return self._cellAtPoint(component,
+                                                 x + direction * (width * step // height),
+                                                 y + direction * step)
+                missed = -1
+                for i in range(_VIEWPORT_PROBES):
+                        step = height * i // (2 * _VIEWPORT_PROBES)
+                        if step <= missed:
+                                continue
+                        cell = probe(step)
+                        if cell is not None:
+                                break
+                        missed = step
+                else:
+                        return None
+                while step - missed > 1:
+                        middle = (step + missed) // 2
+                        found = probe(middle)
+                        if found is None:
+                                missed = middle
+                        else:
+                                step, cell = middle, found
+                return cell
+
+        def _cellAtPoint(self, component, x, y):
+                child = component.getAccessibleAtPoint(x, y, XY_SCREEN)
+                if not child:
+                        return None
+                index = child.getIndexInParent()
+                if index < 0:
+                        return None
+                row = self.table.getRowAtIndex(index)
+                column = self.table.getColumnAtIndex(index)
+                if row < 0 or column < 0:
+                        return None
+                return (row, column)
+
+        def refresh(self):
+                """
+                Updates the visible window, reading the cells that scrolled into
+                the cached window. Rows that stay within the window are kept.
+                """
+                visible = self.getVisibleRange()
+                self.visible = visible
+                if visible is None:
+                        return
+                window = self._window
+                if window is not None and \
+                   window[0] <= visible[0] and visible[1] <= window[1] and \
+                   window[2] <= visible[2] and visible[3] <= window[3]:
+                        return
+                rowStart, rowStop, columnStart, columnStop = visible
+                self._slide((max(rowStart - self.margin, 0),
+                             min(rowStop + self.margin, self.table.nRows),
+                             max(columnStart - self.margin, 0),
+                             min(columnStop + self.margin, self.table.nColumns)))
+
+        def _slide(self, window):
+                old = self._window
+                top = bottom = window[0]
+                if old is not None and old[2:] == window[2:]:
+                        top, bottom = max(old[0], window[0]), min(old[1], window[1])
+                if top < bottom:
+                        kept = self._rows[top - old[0]:bottom - old[0]]
+                else:
+                        top = bottom = window[0]
+                        kept = []
+                self._rows = self._fetchRows(window[0], top, window) + kept + \
+                             self._fetchRows(bottom, window[1], window)
+                self._window = window
+
+        def _fetchRows(self, start, stop, window):
+                if start >= stop:
+                        return []
+                return self.table.getGridSnapshot(rows=(start, stop),
+                                                  columns=(window[2], window[3]),
+                                                  fields=self.fields)
+
+        def getCell(self, row, column):
+                """
+                Gets a cell of the table, from the cache when it lies within the
+                cached window.
+                @return a TableGridCell, or None if there is no cell at this
+                position.
+                """
+                if self._window is None:
+                        self.refresh()
+                window = self._window
+                if window is not None and window[0] <= row < window[1] and \
+                   window[2] <= column < window[3]:
+                        return self._rows[row - window[0]][column - window[2]]
+                grid = self.table.getGridSnapshot(rows=(row, row + 1),
+                                                  columns=(column, column + 1),
+                                                  fields=self.fields)
+                if grid and grid[0]:
+                        return grid[0][0]
+                return None
+
+        def getVisibleCells(self):
+                """
+                @return the visible cells, as a list of rows of TableGridCell
+                objects (None where there is no cell).
+                """
+                if self._window is None:
+                        self.refresh()
+                if self.visible is None or self._window is None:
+                        return []
+                window = self._window
+                rowStart, rowStop, columnStart, columnStop = self.visible
+                return [row[columnStart - window[2]:columnStop - window[2]]
+                        for row in self._rows[rowStart - window[0]:rowStop - window[0]]]
+
 #END----------------------------------------------------------------------------
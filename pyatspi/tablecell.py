@@ -15,6 +15,7 @@
 from gi.repository import Atspi
 from pyatspi.utils import *
 from pyatspi.interface import *
+from pyatspi.table import _getTableMap
 
 __all__ = [
            "TableCell",
@@ -36,10 +37,17 @@ class TableCell(interface):
         columnSpan = property(fget=get_columnSpan, doc=_columnSpanDoc)
 
         def get_columnHeaderCells(self):
-                return Atspi.TableCell.get_column_header_cells(self.obj)
+                table = self._getTable()
+                if table is None:
+                        return Atspi.TableCell.get_column_header_cells(self.obj)
+                tableMap = _getTableMap(table)
+                return tableMap.lookup(tableMap.columnHeaderCells, self.obj,
+                                       Atspi.TableCell.get_column_header_cells, self.obj)
         _columnHeaderCellsDoc = \
                 """
-                Get the column headers as an array of cell accessibles.
+                Get the column headers as an array of cell accessibles. While
+                the registry's main loop runs (Registry.started), they are
+                cached per cell until the table model or its headers change.
                 """
         columnHeaderCells = property(fget=get_columnHeaderCells, doc=_columnHeaderCellsDoc)
 
@@ -52,10 +60,17 @@ class TableCell(interface):
         rowSpan = property(fget=get_rowSpan, doc=_rowSpanDoc)
 
         def get_rowHeaderCells(self):
-                return Atspi.TableCell.get_row_header_cells(self.obj)
+                table = self._getTable()
+                if table is None:
+                        return Atspi.TableCell.get_row_header_cells(self.obj)
+                tableMap = _getTableMap(table)
+                return tableMap.lookup(tableMap.rowHeaderCells, self.obj,
+                                       Atspi.TableCell.get_row_header_cells, self.obj)
         _rowHeaderCellsDoc = \
                 """
-                Get the row headers as an array of cell accessibles.
+                Get the row headers as an array of cell accessibles. While
+                the registry's main loop runs (Registry.started), they are
+                cached per cell until the table model or its headers change.
                 """
         rowHeaderCells = property(fget=get_rowHeaderCells, doc=_rowHeaderCellsDoc)
 
@@ -73,6 +88,15 @@ class TableCell(interface):
                 """
                 return Atspi.TableCell.get_row_column_span(self.obj)
 
+        def _getTable(self):
+                # Header cells are shared through the map of the containing
+                # table; its parent usually is that table, and the parent is
+                # known locally, unlike the result of get_table.
+                parent = self.obj.get_parent()
+                if parent and Atspi.Accessible.get_table_iface(parent):
+                        return parent
+                return Atspi.TableCell.get_table(self.obj)
+
         def get_table(self):
                 return Atspi.TableCell.get_table(self.obj)
         _tableDoc = \
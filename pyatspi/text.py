@@ -39,6 +39,8 @@ __all__ = [
            "TEXT_GRANULARITY_SENTENCE",
            "TEXT_GRANULARITY_LINE",
            "TEXT_GRANULARITY_PARAGRAPH",
+           "iterTextUnits",
+           "TextSelections",
           ]
 
 #------------------------------------------------------------------------------
@@ -123,7 +125,7 @@ class Text(interface):
         and the set returned at a particular character offset via Text::getAttributeRun.
         """
 
-        def addSelection(self, index):
+        def addSelection(self, startOffset, endOffset):
                 """
                 The result of calling addSelection on objects which already have
                 one selection present, and which do not include STATE_MULTISELECTABLE,
@@ -135,7 +137,7 @@ class Text(interface):
                 other reasons (for instance if the user does not have permission
                 to copy the text into the relevant selection buffer).
                 """
-                return Atspi.Text.add_selection(self.obj, index)
+                return Atspi.Text.add_selection(self.obj, startOffset, endOffset)
 
         def getAttributeRun(self, offset, includeDefaults=True):
                 """
@@ -591,3 +593,323 @@ def rangeToList(r):
 
 def textRangeToList(r):
         return (r.content, r.start_offset, r.end_offset)
+
+#------------------------------------------------------------------------------
+
+def _isWordSymbol(c):
+        return c.isalnum()
+
+def _isSentenceSymbol(c):
+        return c >= u' ' and c not in u'.!?'
+
+def _isLineSymbol(c):
+        return c != u'\n'
+
+# Characters, which make up tokens for each boundary type. Units of a boundary
+# type are delimited by starts (or ends) of the tokens.
+_TOKEN_SYMBOLS = {
+        int(TEXT_BOUNDARY_WORD_START): _isWordSymbol,
+        int(TEXT_BOUNDARY_WORD_END): _isWordSymbol,
+        int(TEXT_BOUNDARY_SENTENCE_START): _isSentenceSymbol,
+        int(TEXT_BOUNDARY_SENTENCE_END): _isSentenceSymbol,
+        int(TEXT_BOUNDARY_LINE_START): _isLineSymbol,
+        int(TEXT_BOUNDARY_LINE_END): _isLineSymbol,
+}
+
+class _ChunkEdge(Exception):
+        """
+        Raised when a unit can not be computed without the text outside
+        of the fetched chunk.
+        """
+
+        def __init__(self, offset):
+                Exception.__init__(self, offset)
+                self.offset = offset
+
+class _TextChunk(object):
+        """
+        A fragment of the text content, fetched in one call, in which text
+        units are computed locally.
+        """
+
+        def __init__(self, text, start, end, count):
+                self.start = start
+                self.count = count
+                self.encoded = False
+                self.string = self._fetch(text, start, end)
+                self.end = start + len(self.string)
+
+        def _fetch(self, text, start, end):
+                string = text.getText(start, end)
+                if not isinstance(string, type(u'')):
+                        self.encoded = True
+                        string = string.decode('utf-8')
+                return string
+
+        def extend(self, text, start, end):
+                """
+                Fetches the text from start to end that the chunk does not
+                hold yet, so that a unit crossing its edge can be computed.
+                """
+                if start < self.start:
+                        self.string = self._fetch(text, start, self.start) + self.string
+                        self.start = start
+                if end > self.end:
+                        self.string += self._fetch(text, self.end, end)
+                        self.end = self.start + len(self.string)
+
+        def __contains__(self, offset):
+                return self.start <= offset < self.end
+
+        def _isSymbol(self, offset, isSymbol):
+                if offset < self.start or offset >= self.end:
+                        raise _ChunkEdge(offset)
+                return isSymbol(self.string[offset - self.start])
+
+        def _find(self, offset, step, isSymbol, value):
+                """
+                Returns the first offset from offset in the direction of step
+                where isSymbol is value, or -1 / count if the text bound is reached.
+                """
+                while 0 <= offset < self.count:
+                        if self._isSymbol(offset, isSymbol) == value:
+                                return offset
+                        offset += step
+                return offset
+
+        def _text(self, start, end):
+                if start < self.start:
+                        raise _ChunkEdge(start)
+                if end > self.end:
+                        raise _ChunkEdge(end - 1)
+                string = self.string[start - self.start:end - self.start]
+                if self.encoded:
+                        string = string.encode('utf-8')
+                return string
+
+        def unitAtOffset(self, offset, type):
+                """
+                Computes the unit, which Text.getTextAtOffset returns for offset,
+                assuming tokens are made of isSymbol characters.
+
+                @return a (text, startOffset, endOffset) triple, or None if there
+                is no unit at offset.
+                """
+                if type == TEXT_BOUNDARY_CHAR:
+                        return (self._text(offset, offset + 1), offset, offset + 1)
+                isSymbol = _TOKEN_SYMBOLS[int(type)]
+                if type in (TEXT_BOUNDARY_WORD_START, TEXT_BOUNDARY_SENTENCE_START, TEXT_BOUNDARY_LINE_START):
+                        # from the start of the current (or previous) token
+                        # to the start of the next one
+                        if self._isSymbol(offset, isSymbol):
+                                start = self._find(offset, -1, isSymbol, False) + 1
+                        else:
+                                if offset == 0:
+                                        return None
+                                previous = self._find(offset, -1, isSymbol, True)
+                                if previous < 0:
+                                        return None
+                                start = self._find(previous, -1, isSymbol, False) + 1
+                        end = self._find(offset, 1, isSymbol, False)
+                        if end < self.count:
+                                end = self._find(end, 1, isSymbol, True)
+                else:
+                        # from the end of the previous token to the end
+                        # of the current (or next) one
+                        tokenStart = self._find(offset, 1, isSymbol, True)
+                        if tokenStart >= self.count:
+                                return None
+                        end = self._find(tokenStart, 1, isSymbol, False)
+                        if tokenStart == offset:
+                                tokenStart = self._find(offset, -1, isSymbol, False) + 1
+                        gap = self._find(tokenStart, -1, isSymbol, False)
+                        if gap <= 0:
+                                start = 0
+                        else:
+                                start = self._find(gap, -1, isSymbol, True) + 1
+                return (self._text(start, end), start, end)
+
+def iterTextUnits(text, type, start=0, end=-1, chunkSize=4096, localRules=None):
+        """
+        Iterates over the consecutive text units of the given boundary type,
+        starting from the unit at start offset, as a reading loop over
+        Text.getTextAtOffset would do. Instead of a call per unit, the text
+        is fetched in chunks and the units are computed locally.
+
+        Words are runs of alphanumeric characters and sentences end at '.',
+        '!', '?' or a control character. Lines are only computed locally,
+        as ending at a newline, with localRules, since toolkits also break
+        lines where the text wraps. Remote calls are made to fetch the
+        chunks, extended when a unit crosses their edge, and to check the
+        first unit of each chunk; if the object delimits units differently,
+        the remaining units are requested one by one.
+        @param : text
+        the Text interface of an object.
+        @param : type
+        the TEXT_BOUNDARY_TYPE of the units.
+        @param : start
+        the offset of the first unit.
+        @param : end
+        the offset, at which iteration stops, or -1 for the end of the text.
+        @param : chunkSize
+        the number of characters fetched at once.
+        @param : localRules
+        True to also compute line units locally, False to request word,
+        sentence and line units one by one. By default, word and sentence
+        units are computed locally.
+        @return a generator of (text, startOffset, endOffset) triples, as
+        returned by Text.getTextAtOffset.
+        """
+        count = text.characterCount
+        if end < 0 or end > count:
+                end = count
+        if localRules is None:
+                localRules = int(type) not in (int(TEXT_BOUNDARY_LINE_START),
+                                               int(TEXT_BOUNDARY_LINE_END))
+        local = type == TEXT_BOUNDARY_CHAR or (localRules and int(type) in _TOKEN_SYMBOLS)
+        # characters before the offset, needed to find the start of a unit
+        lookBehind = chunkSize // 4
+        chunk = None
+        verify = False
+        offset = start
+        while offset < end:
+                unit = None
+                if local:
+                        if chunk is None or offset not in chunk:
+                                chunkStart = max(0, offset - lookBehind)
+                                chunk = _TextChunk(text, chunkStart, min(count, offset + chunkSize), count)
+                                verify = True
+                        while True:
+                                try:
+                                        unit = chunk.unitAtOffset(offset, type)
+                                        break
+                                except _ChunkEdge as edge:
+                                        # the unit crosses the edge of the chunk
+                                        size = len(chunk.string)
+                                        if edge.offset < chunk.start:
+                                                chunk.extend(text, max(0, chunk.start - chunkSize), chunk.end)
+                                        else:
+                                                chunk.extend(text, chunk.start, min(count, chunk.end + chunkSize))
+                                        if len(chunk.string) == size:
+                                                break
+                if unit is None:
+                        unit = text.getTextAtOffset(offset, type)
+                elif verify:
+                        verify = False
+                        remote = text.getTextAtOffset(offset, type)
+                        if tuple(remote[1:]) != unit[1:]:
+                                local = False
+                                unit = remote
+                if unit[2] <= offset:
+                        # no unit at offset, go to the next one
+                        unit = text.getTextAfterOffset(offset, type)
+                        if unit[2] <= offset:
+                                return
+                yield tuple(unit)
+                offset = unit[2]
+
+#------------------------------------------------------------------------------
+
+class TextSelections(object):
+        """
+        A snapshot of all selections of a Text object, as a list of
+        (startOffset, endOffset) pairs sorted by offset. The snapshot is
+        read once, and apply() changes the selections of the object with
+        the minimum number of calls, instead of clearing and re-adding them.
+
+        Selections are sorted after they are read, as objects need not keep
+        them in offset order. apply() relies on the selection indexes of the
+        object following offset order; when they do not, it removes all the
+        selections and adds the new ones instead.
+        """
+
+        def __init__(self, text):
+                """
+                @param : text
+                the Text interface of an object.
+                """
+                self._text = text
+                self.refresh()
+
+        def refresh(self):
+                """
+                Reads the current selections of the object.
+                """
+                text = self._text
+                ranges = [tuple(text.getSelection(i)) for i in range(text.getNSelections())]
+                self._ranges = sorted(ranges)
+                self._inOrder = self._ranges == ranges
+
+        def __len__(self):
+                return len(self._ranges)
+
+        def __getitem__(self, index):
+                return self._ranges[index]
+
+        def __iter__(self):
+                return iter(self._ranges)
+
+        def __eq__(self, other):
+                return list(self._ranges) == [tuple(r) for r in other]
+
+        def __ne__(self, other):
+                return not self.__eq__(other)
+
+        def apply(self, ranges):
+                """
+                Makes the selections of the object equal to the given ranges.
+                Only the selections which differ from the snapshot are changed:
+                surplus selections are removed from the end, changed ones are
+                set in place and missing ones are added.
+                @param : ranges
+                a sequence of non-overlapping (startOffset, endOffset) pairs.
+                @return True if all the selections were successfully updated,
+                False otherwise (the snapshot is then re-read from the object).
+                """
+                text = self._text
+                ranges = sorted(tuple(r) for r in ranges)
+                if not self._inOrder:
+                        return self._replace(ranges)
+                current = self._ranges
+                ok = True
+                for index in range(len(current) - 1, len(ranges) - 1, -1):
+                        ok = text.removeSelection(index) and ok
+                # a selection is set only when it doesn't overlap its neighbours
+                # in their current state, so that the order of selections is kept
+                state = current[:len(ranges)]
+                pending = [i for i in range(len(state)) if state[i] != ranges[i]]
+                while pending:
+                        blocked = []
+                        for index in pending:
+                                start, end = ranges[index]
+                                if (index > 0 and state[index - 1][1] > start) or \
+                                   (index + 1 < len(state) and state[index + 1][0] < end):
+                                        blocked.append(index)
+                                        continue
+                                ok = text.setSelection(index, start, end) and ok
+                                state[index] = ranges[index]
+                        if len(blocked) == len(pending):
+                                return self._failed()
+                        pending = blocked
+                for index in range(len(current), len(ranges)):
+                        ok = text.addSelection(ranges[index][0], ranges[index][1]) and ok
+                if not ok:
+                        return self._failed()
+                self._ranges = ranges
+                return True
+
+        def _replace(self, ranges):
+                text = self._text
+                ok = True
+                for index in range(len(self._ranges) - 1, -1, -1):
+                        ok = text.removeSelection(index) and ok
+                for start, end in ranges:
+                        ok = text.addSelection(start, end) and ok
+                if not ok:
+                        return self._failed()
+                self.refresh()
+                return True
+
+        def _failed(self):
+                self.refresh()
+                return False
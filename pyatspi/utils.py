@@ -23,6 +23,7 @@ import pyatspi.Accessibility
 from pyatspi.deviceevent import allModifiers
 import pyatspi.state as state
 import pyatspi.registry as registry
+import sys
 
 #from deviceevent import *
 
@@ -46,7 +47,12 @@ __all__ = [
                 "rectToList",
                 "attributeListToHash",
                 "hashToAttributeList",
-                "getBoundingBox"
+                "BoundingBox",
+                "getBoundingBox",
+                "intersectExtents",
+                "findExtentsAtPoint",
+                "findExtentsIntersecting",
+                "unionOfExtents"
          ]
 
 def setCacheLevel(level):
@@ -56,7 +62,10 @@ def getCacheLevel():
         return None
 
 def clearCache():
-        pass
+        # Nothing to clear if tables were never used.
+        table = sys.modules.get("pyatspi.table")
+        if table is not None:
+                table._clearTableMaps()
 
 def printCache():
         print("Print cache function is deprecated")
@@ -349,35 +358,194 @@ def attributeListToHash(list):
 def hashToAttributeList(h):
         return [x + ":" + h[x] for x in h.keys()]
 
-class BoundingBox(list):
-        def __new__(cls, x, y, width, height):
-                return list.__new__(cls, (x, y, width, height))
+class BoundingBox(object):
+        """
+        A rectangle, as x, y, width and height. It also behaves as the list
+        [x, y, width, height]: it can be indexed, assigned by index,
+        unpacked and compared with lists, as when boxes were lists. They are
+        no longer instances of list: slicing gives a tuple, and list methods
+        such as append, index, count or concatenation with + are gone.
+        """
+
+        __slots__ = ("x", "y", "width", "height")
+
         def __init__(self, x, y, width, height):
-                list.__init__(self, (x, y, width, height))
+                self.x = x
+                self.y = y
+                self.width = width
+                self.height = height
 
         def __str__(self):
                 return ("(%d, %d, %d, %d)" % (self.x, self.y, self.width, self.height))
 
-        def _get_x(self):
-                return self[0]
-        def _set_x(self, val):
-                self[0] = val
-        x = property(fget=_get_x, fset=_set_x)
-        def _get_y(self):
-                return self[1]
-        def _set_y(self, val):
-                self[1] = val
-        y = property(fget=_get_y, fset=_set_y)
-        def _get_width(self):
-                return self[2]
-        def _set_width(self, val):
-                self[2] = val
-        width = property(fget=_get_width, fset=_set_width)
-        def _get_height(self):
-                return self[3]
-        def _set_height(self, val):
-                self[3] = val
-        height = property(fget=_get_height, fset=_set_height)
+        def __repr__(self):
+                return repr([self.x, self.y, self.width, self.height])
+
+        def __len__(self):
+                return 4
+
+        def __iter__(self):
+                yield self.x
+                yield self.y
+                yield self.width
+                yield self.height
+
+        def __getitem__(self, index):
+                return (self.x, self.y, self.width, self.height)[index]
+
+        def __setitem__(self, index, value):
+                setattr(self, BoundingBox.__slots__[index], value)
+
+        def __eq__(self, other):
+                if isinstance(other, BoundingBox):
+                        return self.x == other.x and self.y == other.y and \
+                               self.width == other.width and self.height == other.height
+                if isinstance(other, (list, tuple)):
+                        return [self.x, self.y, self.width, self.height] == list(other)
+                return NotImplemented
+
+        def __ne__(self, other):
+                result = self.__eq__(other)
+                if result is NotImplemented:
+                        return result
+                return not result
+
+        __hash__ = None
+
+        def __getstate__(self):
+                return (self.x, self.y, self.width, self.height)
+
+        def __setstate__(self, state):
+                self.x, self.y, self.width, self.height = state
+
+        def isEmpty(self):
+                """
+                @return True if the box has no area.
+                """
+                return self.width <= 0 or self.height <= 0
+
+        def contains(self, x, y):
+                """
+                @return True if the point (x, y) lies within the box.
+                """
+                return self.x <= x < self.x + self.width and self.y <= y < self.y + self.height
+
+        def containsBox(self, other):
+                """
+                @return True if the box other lies entirely within this box.
+                """
+                return self.x <= other.x and self.y <= other.y and \
+                       other.x + other.width <= self.x + self.width and \
+                       other.y + other.height <= self.y + self.height
+
+        def intersection(self, other):
+                """
+                @return the BoundingBox common to this box and other, or None if
+                they do not overlap.
+                """
+                x = max(self.x, other.x)
+                y = max(self.y, other.y)
+                right = min(self.x + self.width, other.x + other.width)
+                bottom = min(self.y + self.height, other.y + other.height)
+                if right <= x or bottom <= y:
+                        return None
+                return BoundingBox(x, y, right - x, bottom - y)
+
+        def union(self, other):
+                """
+                @return the smallest BoundingBox containing this box and other.
+                """
+                x = min(self.x, other.x)
+                y = min(self.y, other.y)
+                right = max(self.x + self.width, other.x + other.width)
+                bottom = max(self.y + self.height, other.y + other.height)
+                return BoundingBox(x, y, right - x, bottom - y)
 
 def getBoundingBox(rect):
         return BoundingBox (rect.x, rect.y, rect.width, rect.height)
+
+# The functions below work on packed extents, such as those returned by
+# getExtentsBatch: a flat sequence holding x, y, width and height of each
+# rectangle in turn.
+
+def intersectExtents(extents, box):
+        """
+        Clips packed extents to a box.
+
+        @param extents: Packed extents
+        @type extents: array or list of integer
+        @param box: Clipping box
+        @type box: BoundingBox
+        @return: The clipped extents, in a new sequence of the same type;
+                rectangles outside the box get a zero width and height
+        @rtype: array or list of integer
+        """
+        result = extents[:]
+        left, top = box.x, box.y
+        right, bottom = left + box.width, top + box.height
+        for i in range(0, len(extents), 4):
+                x, y = extents[i], extents[i + 1]
+                x1 = max(x, left)
+                y1 = max(y, top)
+                x2 = min(x + extents[i + 2], right)
+                y2 = min(y + extents[i + 3], bottom)
+                if x2 <= x1 or y2 <= y1:
+                        result[i + 2] = result[i + 3] = 0
+                else:
+                        result[i] = x1
+                        result[i + 1] = y1
+                        result[i + 2] = x2 - x1
+                        result[i + 3] = y2 - y1
+        return result
+
+def findExtentsAtPoint(extents, x, y):
+        """
+        @param extents: Packed extents
+        @type extents: array or list of integer
+        @return: The indices of the rectangles containing the point (x, y)
+        @rtype: list of integer
+        """
+        return [i // 4 for i in range(0, len(extents), 4)
+                if extents[i] <= x < extents[i] + extents[i + 2] and
+                   extents[i + 1] <= y < extents[i + 1] + extents[i + 3]]
+
+def findExtentsIntersecting(extents, box):
+        """
+        @param extents: Packed extents
+        @type extents: array or list of integer
+        @param box: Box to test against
+        @type box: BoundingBox
+        @return: The indices of the rectangles overlapping the box
+        @rtype: list of integer
+        """
+        left, top = box.x, box.y
+        right, bottom = left + box.width, top + box.height
+        return [i // 4 for i in range(0, len(extents), 4)
+                if extents[i] < right and left < extents[i] + extents[i + 2] and
+                   extents[i + 1] < bottom and top < extents[i + 1] + extents[i + 3] and
+                   extents[i + 2] > 0 and extents[i + 3] > 0]
+
+def unionOfExtents(extents):
+        """
+        @param extents: Packed extents
+        @type extents: array or list of integer
+        @return: The smallest box containing all the non-empty rectangles,
+                or None if there are none
+        @rtype: BoundingBox
+        """
+        left = top = right = bottom = None
+        for i in range(0, len(extents), 4):
+                width, height = extents[i + 2], extents[i + 3]
+                if width <= 0 or height <= 0:
+                        continue
+                x, y = extents[i], extents[i + 1]
+                if left is None:
+                        left, top, right, bottom = x, y, x + width, y + height
+                else:
+                        left = min(left, x)
+                        top = min(top, y)
+                        right = max(right, x + width)
+                        bottom = max(bottom, y + height)
+        if left is None:
+                return None
+        return BoundingBox(left, top, right - left, bottom - top)
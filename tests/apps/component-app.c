@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include <gmodule.h>
 #include <atk/atk.h>
 #include <my-atk.h>
@@ -10,31 +11,113 @@ static const AtkLayer layers[] = {ATK_LAYER_WINDOW, ATK_LAYER_WIDGET, ATK_LAYER_
 static const guint zorders[] = {0, -100, 100};
 static const gboolean extent_may_changed[] = {TRUE, FALSE, TRUE};
 
+/*
+ * Overlapping MDI windows, added after the components above. Window i is
+ * cascaded by WINDOW_STEP pixels from window i-1 and stacked above it; each
+ * holds a grid of widgets, and a popup covers part of the main window.
+ */
+#define DEF_WINDOWS     4   /* default number of MDI windows */
+#define WINDOW_SIZE     30
+#define WINDOW_STEP     8
+#define WIDGET_GRID     3   /* widgets per row and per column of a window */
+#define WIDGET_SIZE     (WINDOW_SIZE / WIDGET_GRID)
+
+static const AtkRectangle popup_extent = {50,0,20,20};
+
+/*
+ * Each call of test_next changes the first widget of the first window:
+ * stage 1 moves it to moved_extent, stage 2 hides it.
+ */
+static const AtkRectangle moved_extent = {60,60,10,10};
+static MyAtkComponent *first_widget = NULL;
+static gint stage = 0;
+
+static MyAtkComponent *
+new_component (gint x, gint y, gint width, gint height, AtkLayer layer, gint zorder)
+{
+  MyAtkComponent *mycomp = MY_ATK_COMPONENT(g_object_new(MY_TYPE_ATK_COMPONENT, NULL));
+  MyAtkObject *obj = MY_ATK_OBJECT(mycomp);
+
+  mycomp->extent.x = x;
+  mycomp->extent.y = y;
+  mycomp->extent.width = width;
+  mycomp->extent.height = height;
+  mycomp->layer = layer;
+  mycomp->zorder = zorder;
+
+  if (obj->state_set == NULL)
+    obj->state_set = atk_state_set_new();
+  atk_state_set_add_state(obj->state_set, ATK_STATE_VISIBLE);
+  atk_state_set_add_state(obj->state_set, ATK_STATE_SHOWING);
+  return mycomp;
+}
+
+static void
+add_windows (MyAtkObject *root, gint nwindows)
+{
+  gint i, row, col;
+
+  for (i = 0; i < nwindows; i++)
+    {
+      gint x = (i * WINDOW_STEP) % (70 - WINDOW_SIZE);
+      gint y = (i * WINDOW_STEP) % (70 - WINDOW_SIZE);
+      MyAtkComponent *window = new_component(x, y, WINDOW_SIZE, WINDOW_SIZE,
+                                             ATK_LAYER_MDI, i);
+
+      ATK_OBJECT(window)->name = g_strdup_printf("window %d", i);
+      ATK_OBJECT(window)->role = ATK_ROLE_INTERNAL_FRAME;
+      for (row = 0; row < WIDGET_GRID; row++)
+        for (col = 0; col < WIDGET_GRID; col++)
+          {
+            MyAtkComponent *widget = new_component(x + col * WIDGET_SIZE,
+                                                   y + row * WIDGET_SIZE,
+                                                   WIDGET_SIZE, WIDGET_SIZE,
+                                                   ATK_LAYER_WIDGET, 0);
+            my_atk_object_add_child(MY_ATK_OBJECT(window), MY_ATK_OBJECT(widget));
+            if (first_widget == NULL)
+              first_widget = widget;
+          }
+      my_atk_object_add_child(root, MY_ATK_OBJECT(window));
+    }
+}
+
 G_MODULE_EXPORT void
 test_init (gchar *path)
 {
   int i;
+  gint nwindows = DEF_WINDOWS;
+  const gchar *env;
   AtkObject *atk;
+  MyAtkComponent *popup;
 
   if (path == NULL)
      g_error("No test data path provided");
   tdata_path = path;
 
+  env = g_getenv("TEST_COMPONENT_WINDOWS");
+  if (env != NULL)
+    nwindows = atoi(env);
+
   g_type_init();
   for(i = 0; i < sizeof(comps) / sizeof(comps[0]); i++)
     {
-      MyAtkComponent *mycomp = MY_ATK_COMPONENT(g_object_new(MY_TYPE_ATK_COMPONENT, NULL));
-        
-      mycomp->extent = extents[i];
+      MyAtkComponent *mycomp = new_component(extents[i].x, extents[i].y,
+                                             extents[i].width, extents[i].height,
+                                             layers[i], zorders[i]);
+
       mycomp->is_extent_may_changed = extent_may_changed[i];
-      mycomp->layer = layers[i];
-      mycomp->zorder = zorders[i];
-      
       comps[i] = ATK_COMPONENT(mycomp);
     }
     
   my_atk_object_add_child(MY_ATK_OBJECT(comps[2]), MY_ATK_OBJECT(comps[0]));
   my_atk_object_add_child(MY_ATK_OBJECT(comps[2]), MY_ATK_OBJECT(comps[1]));
+  add_windows(MY_ATK_OBJECT(comps[2]), nwindows);
+
+  popup = new_component(popup_extent.x, popup_extent.y,
+                        popup_extent.width, popup_extent.height,
+                        ATK_LAYER_POPUP, 0);
+  ATK_OBJECT(popup)->role = ATK_ROLE_POPUP_MENU;
+  my_atk_object_add_child(MY_ATK_OBJECT(comps[2]), MY_ATK_OBJECT(popup));
 
     atk = ATK_OBJECT (comps [2]);
     atk->name = g_strdup ("atspi-test-main");
@@ -45,6 +128,22 @@ G_MODULE_EXPORT void
 test_next (int argc, char *argv[])
 {
   g_print("Moving to next stage\n");
+  if (first_widget == NULL)
+    return;
+
+  stage++;
+  if (stage == 1)
+    {
+      atk_component_set_extents(ATK_COMPONENT(first_widget),
+                                moved_extent.x, moved_extent.y,
+                                moved_extent.width, moved_extent.height,
+                                ATK_XY_SCREEN);
+    }
+  else if (stage == 2)
+    {
+      atk_state_set_remove_state(MY_ATK_OBJECT(first_widget)->state_set, ATK_STATE_SHOWING);
+      atk_object_notify_state_change(ATK_OBJECT(first_widget), ATK_STATE_SHOWING, FALSE);
+    }
 }
 
 G_MODULE_EXPORT void
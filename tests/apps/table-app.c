@@ -0,0 +1,54 @@
+#include <stdlib.h>
+#include <gmodule.h>
+#include <atk/atk.h>
+#include <my-atk.h>
+
+/* The size of the table can be changed through the environment, so that
+ * the same application serves for measuring queries on big tables */
+#define DEF_TABLE_ROWS 1000
+#define DEF_TABLE_COLUMNS 8
+
+static AtkObject *root_accessible;
+
+static gint
+get_size (const gchar *variable, gint def)
+{
+  const gchar *value = g_getenv (variable);
+
+  return value ? atoi (value) : def;
+}
+
+G_MODULE_EXPORT void
+test_init (gchar *path)
+{
+  MyAtkTable *table;
+
+  g_type_init();
+  root_accessible  = g_object_new(MY_TYPE_ATK_TABLE, NULL);
+  root_accessible->name = g_strdup ("atspi-test-main");
+  root_accessible->role = ATK_ROLE_APPLICATION;
+
+  table = MY_ATK_TABLE (root_accessible);
+  my_atk_table_set_size (table,
+                         get_size ("TEST_TABLE_ROWS", DEF_TABLE_ROWS),
+                         get_size ("TEST_TABLE_COLUMNS", DEF_TABLE_COLUMNS));
+  my_atk_table_set_span (table, 2, 1, 2, 3);
+}
+
+G_MODULE_EXPORT void
+test_next (int argc, char *argv[])
+{
+  g_print("Moving to next stage\n");
+}
+
+G_MODULE_EXPORT void
+test_finished (int argc, char *argv[])
+{
+  g_print("Test has completed\n");
+}
+
+G_MODULE_EXPORT AtkObject *
+test_get_root (void)
+{
+  return root_accessible;
+}
@@ -0,0 +1,49 @@
+#include <gmodule.h>
+#include <atk/atk.h>
+#include <my-atk.h>
+
+static AtkObject *root_accessible;
+
+static const gchar text_contents[] =
+  "This is a test. It has two sentences!\nAnd a second line.";
+
+/* "naïve café 日本語. Second sentence!" in UTF-8 */
+static const gchar multibyte_contents[] =
+  "na\xc3\xafve caf\xc3\xa9 \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e. Second sentence!";
+
+G_MODULE_EXPORT void
+test_init (gchar *path)
+{
+  AtkObject *multibyte;
+
+  g_type_init();
+  root_accessible  = g_object_new(MY_TYPE_ATK_TEXT, NULL);
+  root_accessible->name = g_strdup ("atspi-test-main");
+  root_accessible->role = ATK_ROLE_APPLICATION;
+  atk_editable_text_set_text_contents (ATK_EDITABLE_TEXT (root_accessible), text_contents);
+
+  multibyte = ATK_OBJECT (g_object_new (MY_TYPE_ATK_TEXT,
+                                        "accessible-name", "multibyte",
+                                        "accessible-role", ATK_ROLE_TEXT,
+                                        NULL));
+  atk_editable_text_set_text_contents (ATK_EDITABLE_TEXT (multibyte), multibyte_contents);
+  my_atk_object_add_child (MY_ATK_OBJECT (root_accessible), MY_ATK_OBJECT (multibyte));
+}
+
+G_MODULE_EXPORT void
+test_next (int argc, char *argv[])
+{
+  g_print("Moving to next stage\n");
+}
+
+G_MODULE_EXPORT void
+test_finished (int argc, char *argv[])
+{
+  g_print("Test has completed\n");
+}
+
+G_MODULE_EXPORT AtkObject *
+test_get_root (void)
+{
+  return root_accessible;
+}
@@ -1,28 +1,374 @@
 /* This file contains both declaration and definition of the MyAtkTable,
- * a GObject that pretends to implement the AtkTableIface interface (it 
- * registers appropriate interface), but provides no implementation for any of the
- * methods of this interface (NULL-filled vftbl).
+ * a GObject that implements the AtkTableIface interface over a grid of
+ * cells of configurable size. Cells may span several rows and columns.
+ * Cell objects, headers and descriptions are only created when they are
+ * requested, so the table can have millions of cells.
  */
 
+#include <string.h>
 #include <glib-object.h>
-#include <atk/atk.h> 
+#include <atk/atk.h>
 
 #include "my-atk-object.h"
 #include "my-atk-table.h"
-    
+
 ///////////////////////////////////////////////////////////////////////////
 // Helper functions and data
 ///////////////////////////////////////////////////////////////////////////
+#define BITS_PER_WORD (8 * sizeof (gulong))
+
+static gint
+bitset_n_words (gint n)
+{
+    return (n + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+static gboolean
+bitset_get (const gulong* bits, gint i)
+{
+    return (bits[i / BITS_PER_WORD] >> (i % BITS_PER_WORD)) & 1;
+}
+
+static void
+bitset_set (gulong* bits, gint i, gboolean value)
+{
+    gulong mask = 1UL << (i % BITS_PER_WORD);
+
+    if (value)
+        bits[i / BITS_PER_WORD] |= mask;
+    else
+        bits[i / BITS_PER_WORD] &= ~mask;
+}
+
+static gint
+bitset_count_word (gulong word)
+{
+#ifdef __GNUC__
+    return __builtin_popcountl (word);
+#else
+    gint count = 0;
+
+    for (; word; word &= word - 1)
+        count++;
+    return count;
+#endif
+}
+
+/* Stores the indices of the set bits among the first n ones in a newly
+ * allocated array, and returns their count */
+static gint
+bitset_list (const gulong* bits, gint n, gint** list)
+{
+    gint nwords = bitset_n_words (n);
+    gint count = 0;
+    gint w, k;
+
+    for (w = 0; w < nwords; w++)
+        count += bitset_count_word (bits[w]);
+    if (count == 0)
+    {
+        *list = NULL;
+        return 0;
+    }
+    *list = g_new (gint, count);
+    for (w = 0, k = 0; w < nwords; w++)
+    {
+        gint bit = -1;
+
+        if (bits[w] == 0)
+            continue;
+        while ((bit = g_bit_nth_lsf (bits[w], bit)) >= 0)
+            (*list)[k++] = w * BITS_PER_WORD + bit;
+    }
+    return count;
+}
+
+static AtkObject*
+table_new_object (const gchar* name, AtkRole role)
+{
+    AtkObject* obj = ATK_OBJECT (g_object_new (MY_TYPE_ATK_OBJECT, NULL));
+
+    atk_object_set_name (obj, name);
+    atk_object_set_role (obj, role);
+    return obj;
+}
+
+/* Inserts data at index i of array, moving the following elements */
+static void
+ptr_array_insert (GPtrArray* array, guint i, gpointer data)
+{
+    g_ptr_array_add (array, NULL);
+    memmove (array->pdata + i + 1, array->pdata + i, (array->len - 1 - i) * sizeof (gpointer));
+    array->pdata[i] = data;
+}
+
+static void
+table_row_spans_free (gpointer row_spans)
+{
+    g_ptr_array_free (row_spans, TRUE);
+}
+
+/* Span covering (row, column), or NULL for a cell of one row and column */
+static TableSpan*
+table_span_at (MyAtkTable* self, gint row, gint column)
+{
+    GPtrArray* row_spans = g_hash_table_lookup (self->row_spans, GINT_TO_POINTER (row));
+    guint i;
+
+    if (row_spans == NULL)
+        return NULL;
+    for (i = 0; i < row_spans->len; i++)
+    {
+        TableSpan* span = g_ptr_array_index (row_spans, i);
+
+        if (column < span->column)
+            break;
+        if (column < span->column + span->n_columns)
+            return span;
+    }
+    return NULL;
+}
+
+/* Position of the corner of the cell covering the grid position pos */
+static gint
+table_anchor_at (MyAtkTable* self, gint pos)
+{
+    TableSpan* span = table_span_at (self, pos / self->ncols, pos % self->ncols);
+
+    return span ? span->row * self->ncols + span->column : pos;
+}
+
+/* Number of grid positions before pos that are covered by a span but are
+ * not its corner, that is positions before pos without a child */
+static gint
+table_hidden_before (MyAtkTable* self, gint pos)
+{
+    gint row = pos / self->ncols;
+    gint column = pos % self->ncols;
+    gint hidden = 0;
+    guint i;
+
+    for (i = 0; i < self->spans->len; i++)
+    {
+        TableSpan* span = g_ptr_array_index (self->spans, i);
+
+        /* all the positions of later spans are after their corner */
+        if (span->row * self->ncols + span->column >= pos)
+            break;
+        hidden += CLAMP (row - span->row, 0, span->n_rows) * span->n_columns;
+        if (row >= span->row && row < span->row + span->n_rows)
+            hidden += CLAMP (column - span->column, 0, span->n_columns);
+        hidden--;
+    }
+    return hidden;
+}
+
+static gint
+table_get_n_cells (MyAtkTable* self)
+{
+    return self->nrows * self->ncols - self->n_hidden;
+}
+
+static gint
+table_index_of_anchor (MyAtkTable* self, gint anchor)
+{
+    return anchor - table_hidden_before (self, anchor);
+}
+
+static gint
+table_anchor_of_index (MyAtkTable* self, gint index)
+{
+    gint low, high;
+
+    if (index < 0 || index >= table_get_n_cells (self))
+        return -1;
+    if (self->spans->len == 0)
+        return index;
+    /* the number of children before a position grows with the position:
+     * find the first position with index + 1 children before it */
+    low = index + 1;
+    high = self->nrows * self->ncols;
+    while (low < high)
+    {
+        gint middle = low + (high - low) / 2;
+
+        if (middle - table_hidden_before (self, middle) < index + 1)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low - 1;
+}
+
+static gboolean
+table_is_valid_position (MyAtkTable* self, gint row, gint column)
+{
+    return row >= 0 && row < self->nrows && column >= 0 && column < self->ncols;
+}
+
+/* Cells are renumbered: created cells become defunct */
+static void
+table_drop_cells (MyAtkTable* self)
+{
+    GHashTableIter iter;
+    gpointer cell;
+
+    g_hash_table_iter_init (&iter, self->cells);
+    while (g_hash_table_iter_next (&iter, NULL, &cell))
+        MY_ATK_TABLE_CELL (cell)->index = -1;
+    g_hash_table_remove_all (self->cells);
+}
+
+static const gchar*
+table_get_description (GHashTable* descriptions, const gchar* tpl, gint i)
+{
+    gchar* description = g_hash_table_lookup (descriptions, GINT_TO_POINTER (i));
+
+    if (description == NULL)
+    {
+        description = g_strdup_printf (tpl, i);
+        g_hash_table_insert (descriptions, GINT_TO_POINTER (i), description);
+    }
+    return description;
+}
+
+static AtkObject*
+table_get_header (GHashTable* headers, GHashTable* descriptions,
+                  const gchar* tpl, AtkRole role, gint i)
+{
+    AtkObject* header = g_hash_table_lookup (headers, GINT_TO_POINTER (i));
+
+    if (header == NULL)
+    {
+        header = table_new_object (table_get_description (descriptions, tpl, i), role);
+        g_hash_table_insert (headers, GINT_TO_POINTER (i), header);
+    }
+    return header;
+}
+
+static void
+table_set_header (GHashTable* headers, gint i, AtkObject* header)
+{
+    if (header)
+        g_hash_table_insert (headers, GINT_TO_POINTER (i), g_object_ref (header));
+    else
+        g_hash_table_remove (headers, GINT_TO_POINTER (i));
+}
+
+static void
+table_resize (MyAtkTable* self, gint nrows, gint ncols)
+{
+    table_drop_cells (self);
+    g_hash_table_remove_all (self->row_spans);
+    g_ptr_array_set_size (self->spans, 0);
+    self->n_hidden = 0;
+    g_hash_table_remove_all (self->row_headers);
+    g_hash_table_remove_all (self->col_headers);
+    g_hash_table_remove_all (self->row_descriptions);
+    g_hash_table_remove_all (self->col_descriptions);
+
+    self->nrows = nrows;
+    self->ncols = ncols;
+    g_free (self->selected_rows);
+    g_free (self->selected_cols);
+    self->selected_rows = g_new0 (gulong, bitset_n_words (nrows));
+    self->selected_cols = g_new0 (gulong, bitset_n_words (ncols));
+}
+
+void
+my_atk_table_set_size (MyAtkTable* table, gint nrows, gint ncols)
+{
+    if (nrows < 0 || ncols < 0 || (gint64) nrows * ncols > G_MAXINT)
+    {
+        g_warning ("Incorrect table size %dx%d.", nrows, ncols);
+        return;
+    }
+    table_resize (table, nrows, ncols);
+    g_signal_emit_by_name (table, "model-changed");
+}
+
+/* Makes the cell at (row, column) span n_rows rows and n_columns columns.
+ * Fails if the span goes out of the table or overlaps another span */
+gboolean
+my_atk_table_set_span (MyAtkTable* table, gint row, gint column, gint n_rows, gint n_columns)
+{
+    gint anchor = row * table->ncols + column;
+    gint r;
+    guint i;
+    TableSpan* span;
+
+    if (!table_is_valid_position (table, row, column) || n_rows < 1 || n_columns < 1 ||
+        row + n_rows > table->nrows || column + n_columns > table->ncols)
+    {
+        return FALSE;
+    }
+    for (r = row; r < row + n_rows; r++)
+    {
+        GPtrArray* row_spans = g_hash_table_lookup (table->row_spans, GINT_TO_POINTER (r));
+
+        for (i = 0; row_spans && i < row_spans->len; i++)
+        {
+            TableSpan* other = g_ptr_array_index (row_spans, i);
+
+            if (other->column < column + n_columns && column < other->column + other->n_columns)
+                return FALSE;
+        }
+    }
+    if (n_rows == 1 && n_columns == 1)
+        return TRUE;
+
+    span = g_new (TableSpan, 1);
+    span->row = row;
+    span->column = column;
+    span->n_rows = n_rows;
+    span->n_columns = n_columns;
+    for (i = 0; i < table->spans->len; i++)
+    {
+        TableSpan* other = g_ptr_array_index (table->spans, i);
+
+        if (other->row * table->ncols + other->column > anchor)
+            break;
+    }
+    ptr_array_insert (table->spans, i, span);
+    for (r = row; r < row + n_rows; r++)
+    {
+        GPtrArray* row_spans = g_hash_table_lookup (table->row_spans, GINT_TO_POINTER (r));
+
+        if (row_spans == NULL)
+        {
+            row_spans = g_ptr_array_new ();
+            g_hash_table_insert (table->row_spans, GINT_TO_POINTER (r), row_spans);
+        }
+        for (i = 0; i < row_spans->len; i++)
+        {
+            if (((TableSpan*) g_ptr_array_index (row_spans, i))->column > column)
+                break;
+        }
+        ptr_array_insert (row_spans, i, span);
+    }
+    table->n_hidden += n_rows * n_columns - 1;
+
+    table_drop_cells (table);
+    g_signal_emit_by_name (table, "model-changed");
+    return TRUE;
+}
+
 void
 my_atk_table_select_rows (MyAtkTable* table, gboolean sel_scheme[])
 {
-    // the function does nothing  
+    gint i;
+
+    for (i = 0; i < table->nrows; i++)
+        bitset_set (table->selected_rows, i, sel_scheme[i]);
 }
 
 void
 my_atk_table_select_columns (MyAtkTable* table, gboolean sel_scheme[])
 {
-    // the function does nothing
+    gint i;
+
+    for (i = 0; i < table->ncols; i++)
+        bitset_set (table->selected_cols, i, sel_scheme[i]);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -31,78 +377,389 @@ my_atk_table_select_columns (MyAtkTable* table, gboolean sel_scheme[])
 static GObjectClass *parent_class_table = NULL;
 
 /******************************************************************/
+static AtkObject*
+my_atk_table_ref_at (AtkTable* table, gint row, gint column)
+{
+    gint index = atk_table_get_index_at (table, row, column);
+
+    if (index < 0)
+        return NULL;
+    return atk_object_ref_accessible_child (ATK_OBJECT (table), index);
+}
+
+static gint
+my_atk_table_get_index_at (AtkTable* table, gint row, gint column)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (!table_is_valid_position (self, row, column))
+        return -1;
+    return table_index_of_anchor (self, table_anchor_at (self, row * self->ncols + column));
+}
+
+static gint
+my_atk_table_get_column_at_index (AtkTable* table, gint index)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+    gint anchor = table_anchor_of_index (self, index);
+
+    return anchor < 0 ? -1 : anchor % self->ncols;
+}
+
+static gint
+my_atk_table_get_row_at_index (AtkTable* table, gint index)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+    gint anchor = table_anchor_of_index (self, index);
+
+    return anchor < 0 ? -1 : anchor / self->ncols;
+}
+
+static gint
+my_atk_table_get_n_columns (AtkTable* table)
+{
+    return MY_ATK_TABLE (table)->ncols;
+}
+
+static gint
+my_atk_table_get_n_rows (AtkTable* table)
+{
+    return MY_ATK_TABLE (table)->nrows;
+}
+
+static gint
+my_atk_table_get_column_extent_at (AtkTable* table, gint row, gint column)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+    TableSpan* span;
+
+    if (!table_is_valid_position (self, row, column))
+        return 0;
+    span = table_span_at (self, row, column);
+    return span ? span->n_columns : 1;
+}
+
+static gint
+my_atk_table_get_row_extent_at (AtkTable* table, gint row, gint column)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+    TableSpan* span;
+
+    if (!table_is_valid_position (self, row, column))
+        return 0;
+    span = table_span_at (self, row, column);
+    return span ? span->n_rows : 1;
+}
+
+static AtkObject*
+my_atk_table_get_caption (AtkTable* table)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (self->caption == NULL)
+        self->caption = table_new_object (DEF_CAPTION_TEXT, ATK_ROLE_CAPTION);
+    return self->caption;
+}
+
+static AtkObject*
+my_atk_table_get_summary (AtkTable* table)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (self->summary == NULL)
+        self->summary = table_new_object (DEF_SUMMARY_TEXT, ATK_ROLE_LABEL);
+    return self->summary;
+}
+
+static void
+my_atk_table_set_caption (AtkTable* table, AtkObject* caption)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (caption)
+        g_object_ref (caption);
+    if (self->caption)
+        g_object_unref (self->caption);
+    self->caption = caption;
+}
+
+static void
+my_atk_table_set_summary (AtkTable* table, AtkObject* summary)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (summary)
+        g_object_ref (summary);
+    if (self->summary)
+        g_object_unref (self->summary);
+    self->summary = summary;
+}
+
+static const gchar*
+my_atk_table_get_column_description (AtkTable* table, gint column)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (column < 0 || column >= self->ncols)
+        return NULL;
+    return table_get_description (self->col_descriptions, DEF_COL_DESCR_TPL, column);
+}
+
+static const gchar*
+my_atk_table_get_row_description (AtkTable* table, gint row)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (row < 0 || row >= self->nrows)
+        return NULL;
+    return table_get_description (self->row_descriptions, DEF_ROW_DESCR_TPL, row);
+}
+
+static void
+my_atk_table_set_column_description (AtkTable* table, gint column, const gchar* description)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (column < 0 || column >= self->ncols)
+        return;
+    g_hash_table_insert (self->col_descriptions, GINT_TO_POINTER (column), g_strdup (description));
+}
+
+static void
+my_atk_table_set_row_description (AtkTable* table, gint row, const gchar* description)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (row < 0 || row >= self->nrows)
+        return;
+    g_hash_table_insert (self->row_descriptions, GINT_TO_POINTER (row), g_strdup (description));
+}
+
+static AtkObject*
+my_atk_table_get_column_header (AtkTable* table, gint column)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (column < 0 || column >= self->ncols)
+        return NULL;
+    return table_get_header (self->col_headers, self->col_descriptions,
+                             DEF_COL_DESCR_TPL, ATK_ROLE_TABLE_COLUMN_HEADER, column);
+}
+
+static AtkObject*
+my_atk_table_get_row_header (AtkTable* table, gint row)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (row < 0 || row >= self->nrows)
+        return NULL;
+    return table_get_header (self->row_headers, self->row_descriptions,
+                             DEF_ROW_DESCR_TPL, ATK_ROLE_TABLE_ROW_HEADER, row);
+}
+
+static void
+my_atk_table_set_column_header (AtkTable* table, gint column, AtkObject* header)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (column < 0 || column >= self->ncols)
+        return;
+    table_set_header (self->col_headers, column, header);
+}
+
+static void
+my_atk_table_set_row_header (AtkTable* table, gint row, AtkObject* header)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (row < 0 || row >= self->nrows)
+        return;
+    table_set_header (self->row_headers, row, header);
+}
+
+static gint
+my_atk_table_get_selected_columns (AtkTable* table, gint** selected)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    return bitset_list (self->selected_cols, self->ncols, selected);
+}
+
+static gint
+my_atk_table_get_selected_rows (AtkTable* table, gint** selected)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    return bitset_list (self->selected_rows, self->nrows, selected);
+}
+
+static gboolean
+my_atk_table_is_column_selected (AtkTable* table, gint column)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (column < 0 || column >= self->ncols)
+        return FALSE;
+    return bitset_get (self->selected_cols, column);
+}
+
+static gboolean
+my_atk_table_is_row_selected (AtkTable* table, gint row)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (row < 0 || row >= self->nrows)
+        return FALSE;
+    return bitset_get (self->selected_rows, row);
+}
+
+static gboolean
+my_atk_table_is_selected (AtkTable* table, gint row, gint column)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (!table_is_valid_position (self, row, column))
+        return FALSE;
+    return bitset_get (self->selected_rows, row) || bitset_get (self->selected_cols, column);
+}
+
+static gboolean
+my_atk_table_add_row_selection (AtkTable* table, gint row)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (row < 0 || row >= self->nrows)
+        return FALSE;
+    bitset_set (self->selected_rows, row, TRUE);
+    return TRUE;
+}
+
+static gboolean
+my_atk_table_remove_row_selection (AtkTable* table, gint row)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (row < 0 || row >= self->nrows)
+        return FALSE;
+    bitset_set (self->selected_rows, row, FALSE);
+    return TRUE;
+}
+
+static gboolean
+my_atk_table_add_column_selection (AtkTable* table, gint column)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (column < 0 || column >= self->ncols)
+        return FALSE;
+    bitset_set (self->selected_cols, column, TRUE);
+    return TRUE;
+}
+
+static gboolean
+my_atk_table_remove_column_selection (AtkTable* table, gint column)
+{
+    MyAtkTable* self = MY_ATK_TABLE (table);
+
+    if (column < 0 || column >= self->ncols)
+        return FALSE;
+    bitset_set (self->selected_cols, column, FALSE);
+    return TRUE;
+}
+
 static void
 table_interface_init (gpointer g_iface, gpointer iface_data)
 {
     AtkTableIface *klass = (AtkTableIface *)g_iface;
-    
+
     /* set up overrides here */
-    klass-> ref_at =
-        (AtkObject* (*) (AtkTable *table, gint row, gint column)) NULL;
-    klass-> get_index_at =
-        (gint (*) (AtkTable *table, gint row, gint column)) NULL;
-    klass-> get_column_at_index =
-        (gint (*) (AtkTable *table, gint index_)) NULL;
-    klass-> get_row_at_index =
-        (gint (*) (AtkTable *table, gint index_)) NULL;
-    klass-> get_n_columns =
-        (gint (*) (AtkTable *table)) NULL;
-    klass-> get_n_rows =
-        (gint (*) (AtkTable *table)) NULL;
-    klass-> get_column_extent_at =
-        (gint (*) (AtkTable *table, gint row, gint column)) NULL;
-    klass-> get_row_extent_at =
-        (gint (*) (AtkTable *table, gint row, gint column)) NULL;
-    klass-> get_caption =
-        (AtkObject* (*) (AtkTable *table)) NULL;
-    klass-> get_column_description =
-        (const gchar* (*) (AtkTable *table, gint column)) NULL;
-    klass-> get_column_header =
-        (AtkObject* (*) (AtkTable *table, gint column)) NULL;
-    klass-> get_row_description =
-        (const gchar* (*) (AtkTable *table, gint row)) NULL;
-    klass-> get_row_header =
-        (AtkObject* (*) (AtkTable *table, gint row)) NULL;
-    klass-> get_summary =
-        (AtkObject* (*) (AtkTable *table)) NULL;
-    klass-> set_caption =
-        (void (*) (AtkTable *table, AtkObject *caption)) NULL;
-    klass-> set_column_description =
-        (void (*) (AtkTable *table, gint column, const gchar *description)) NULL;
-    klass-> set_column_header =
-        (void (*) (AtkTable *table, gint column, AtkObject *header)) NULL;
-    klass-> set_row_description =
-        (void (*) (AtkTable *table, gint row, const gchar *description)) NULL;
-    klass-> set_row_header =
-        (void (*) (AtkTable *table, gint row, AtkObject *header)) NULL;
-    klass-> set_summary =
-        (void (*) (AtkTable *table, AtkObject *accessible)) NULL;
-    klass-> get_selected_columns =
-        (gint (*) (AtkTable *table, gint **selected)) NULL;
-    klass-> get_selected_rows =
-        (gint (*) (AtkTable *table, gint **selected)) NULL;
-    klass-> is_column_selected =
-        (gboolean (*) (AtkTable *table, gint column)) NULL;
-    klass-> is_row_selected =
-        (gboolean (*) (AtkTable *table, gint row)) NULL;
-    klass-> is_selected =
-        (gboolean (*) (AtkTable *table, gint row, gint column)) NULL;
-    klass-> add_row_selection =
-        (gboolean (*) (AtkTable *table, gint row)) NULL;
-    klass-> remove_row_selection =
-        (gboolean (*) (AtkTable *table, gint row)) NULL;
-    klass-> add_column_selection =
-        (gboolean (*) (AtkTable *table, gint column)) NULL;
-    klass-> remove_column_selection =
-        (gboolean (*) (AtkTable *table, gint column)) NULL;
+    klass->ref_at = my_atk_table_ref_at;
+    klass->get_index_at = my_atk_table_get_index_at;
+    klass->get_column_at_index = my_atk_table_get_column_at_index;
+    klass->get_row_at_index = my_atk_table_get_row_at_index;
+    klass->get_n_columns = my_atk_table_get_n_columns;
+    klass->get_n_rows = my_atk_table_get_n_rows;
+    klass->get_column_extent_at = my_atk_table_get_column_extent_at;
+    klass->get_row_extent_at = my_atk_table_get_row_extent_at;
+    klass->get_caption = my_atk_table_get_caption;
+    klass->get_column_description = my_atk_table_get_column_description;
+    klass->get_column_header = my_atk_table_get_column_header;
+    klass->get_row_description = my_atk_table_get_row_description;
+    klass->get_row_header = my_atk_table_get_row_header;
+    klass->get_summary = my_atk_table_get_summary;
+    klass->set_caption = my_atk_table_set_caption;
+    klass->set_column_description = my_atk_table_set_column_description;
+    klass->set_column_header = my_atk_table_set_column_header;
+    klass->set_row_description = my_atk_table_set_row_description;
+    klass->set_row_header = my_atk_table_set_row_header;
+    klass->set_summary = my_atk_table_set_summary;
+    klass->get_selected_columns = my_atk_table_get_selected_columns;
+    klass->get_selected_rows = my_atk_table_get_selected_rows;
+    klass->is_column_selected = my_atk_table_is_column_selected;
+    klass->is_row_selected = my_atk_table_is_row_selected;
+    klass->is_selected = my_atk_table_is_selected;
+    klass->add_row_selection = my_atk_table_add_row_selection;
+    klass->remove_row_selection = my_atk_table_remove_row_selection;
+    klass->add_column_selection = my_atk_table_add_column_selection;
+    klass->remove_column_selection = my_atk_table_remove_column_selection;
+}
+
+/******************************************************************/
+static gint
+my_atk_table_get_n_children (AtkObject* accessible)
+{
+    return table_get_n_cells (MY_ATK_TABLE (accessible));
+}
+
+static AtkObject*
+my_atk_table_ref_child (AtkObject* accessible, gint i)
+{
+    MyAtkTable* self = MY_ATK_TABLE (accessible);
+    gint anchor = table_anchor_of_index (self, i);
+    MyAtkTableCell* cell;
+
+    if (anchor < 0)
+        return NULL;
+    cell = g_hash_table_lookup (self->cells, GINT_TO_POINTER (i));
+    if (cell == NULL)
+    {
+        gchar* name = g_strdup_printf (DEF_CELL_NAME_TPL,
+                                       anchor / self->ncols, anchor % self->ncols);
+
+        cell = g_object_new (MY_TYPE_ATK_TABLE_CELL, NULL);
+        cell->index = i;
+        atk_object_set_name (ATK_OBJECT (cell), name);
+        atk_object_set_role (ATK_OBJECT (cell), ATK_ROLE_TABLE_CELL);
+        atk_object_set_parent (ATK_OBJECT (cell), accessible);
+        g_hash_table_insert (self->cells, GINT_TO_POINTER (i), cell);
+        g_free (name);
+    }
+    return g_object_ref (cell);
 }
 
 static void
 table_instance_init (GTypeInstance *instance, gpointer g_class)
 {
     MyAtkTable *self = (MyAtkTable *)instance;
-    
+
     self->disposed = FALSE;
+
+    self->nrows = 0;
+    self->ncols = 0;
+    self->spans = g_ptr_array_new_with_free_func (g_free);
+    self->row_spans = g_hash_table_new_full (NULL, NULL, NULL, table_row_spans_free);
+    self->n_hidden = 0;
+    self->cells = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+    self->selected_rows = NULL;
+    self->selected_cols = NULL;
+    self->row_headers = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+    self->col_headers = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+    self->row_descriptions = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+    self->col_descriptions = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+    self->caption = NULL;
+    self->summary = NULL;
+
+    table_resize (self, NROWS, NCOLS);
 }
 
 static void
@@ -110,14 +767,20 @@ my_atk_table_dispose (GObject *obj)
 {
     MyAtkTable *self = (MyAtkTable *)obj;
 
-    if (self->disposed) 
+    if (self->disposed)
     {
         return;
     }
-    
+
     /* Make sure dispose does not run twice. */
     self->disposed = TRUE;
 
+    table_drop_cells (self);
+    g_hash_table_remove_all (self->row_headers);
+    g_hash_table_remove_all (self->col_headers);
+    my_atk_table_set_caption (ATK_TABLE (self), NULL);
+    my_atk_table_set_summary (ATK_TABLE (self), NULL);
+
     /* Chain up to the parent class */
     G_OBJECT_CLASS (parent_class_table)->dispose (obj);
 }
@@ -125,6 +788,18 @@ my_atk_table_dispose (GObject *obj)
 static void
 my_atk_table_finalize (GObject *obj)
 {
+    MyAtkTable *self = (MyAtkTable *)obj;
+
+    g_hash_table_destroy (self->row_spans);
+    g_ptr_array_free (self->spans, TRUE);
+    g_hash_table_destroy (self->cells);
+    g_hash_table_destroy (self->row_headers);
+    g_hash_table_destroy (self->col_headers);
+    g_hash_table_destroy (self->row_descriptions);
+    g_hash_table_destroy (self->col_descriptions);
+    g_free (self->selected_rows);
+    g_free (self->selected_cols);
+
     /* Chain up to the parent class */
     G_OBJECT_CLASS (parent_class_table)->finalize (obj);
 }
@@ -133,21 +808,25 @@ static void
 my_atk_table_class_init (gpointer g_class, gpointer g_class_data)
 {
     GObjectClass *gobject_class = G_OBJECT_CLASS (g_class);
+    AtkObjectClass *atk_class = ATK_OBJECT_CLASS (g_class);
     MyAtkTableClass *klass = MY_ATK_TABLE_CLASS (g_class);
 
     gobject_class->dispose = my_atk_table_dispose;
     gobject_class->finalize = my_atk_table_finalize;
 
+    atk_class->get_n_children = my_atk_table_get_n_children;
+    atk_class->ref_child = my_atk_table_ref_child;
+
     parent_class_table = g_type_class_peek_parent (klass);
 }
 
-GType 
+GType
 my_atk_table_get_type (void)
 {
     static GType type = 0;
-    if (type == 0) 
+    if (type == 0)
     {
-        static const GTypeInfo info = 
+        static const GTypeInfo info =
         {
             sizeof (MyAtkTableClass),
             NULL,   /* base_init */
@@ -159,8 +838,8 @@ my_atk_table_get_type (void)
             0,      /* n_preallocs */
             table_instance_init    /* instance_init */
         };
-                
-        static const GInterfaceInfo iface_info = 
+
+        static const GInterfaceInfo iface_info =
         {
             (GInterfaceInitFunc) table_interface_init,    /* interface_init */
             NULL,                                       /* interface_finalize */
@@ -175,3 +854,71 @@ my_atk_table_get_type (void)
     }
     return type;
 }
+
+/******************************************************************/
+static gint
+my_atk_table_cell_get_index_in_parent (AtkObject* accessible)
+{
+    return MY_ATK_TABLE_CELL (accessible)->index;
+}
+
+static AtkStateSet*
+my_atk_table_cell_ref_state_set (AtkObject* accessible)
+{
+    MyAtkTableCell* self = MY_ATK_TABLE_CELL (accessible);
+    AtkObject* parent = atk_object_get_parent (accessible);
+    AtkStateSet* state_set = atk_state_set_new ();
+    gint row, column;
+
+    if (self->index < 0 || parent == NULL)
+    {
+        atk_state_set_add_state (state_set, ATK_STATE_DEFUNCT);
+        return state_set;
+    }
+    atk_state_set_add_state (state_set, ATK_STATE_SELECTABLE);
+    row = atk_table_get_row_at_index (ATK_TABLE (parent), self->index);
+    column = atk_table_get_column_at_index (ATK_TABLE (parent), self->index);
+    if (atk_table_is_selected (ATK_TABLE (parent), row, column))
+        atk_state_set_add_state (state_set, ATK_STATE_SELECTED);
+    return state_set;
+}
+
+static void
+table_cell_instance_init (GTypeInstance *instance, gpointer g_class)
+{
+    MY_ATK_TABLE_CELL (instance)->index = -1;
+}
+
+static void
+my_atk_table_cell_class_init (gpointer g_class, gpointer g_class_data)
+{
+    AtkObjectClass *atk_class = ATK_OBJECT_CLASS (g_class);
+
+    atk_class->get_index_in_parent = my_atk_table_cell_get_index_in_parent;
+    atk_class->ref_state_set = my_atk_table_cell_ref_state_set;
+}
+
+GType
+my_atk_table_cell_get_type (void)
+{
+    static GType type = 0;
+    if (type == 0)
+    {
+        static const GTypeInfo info =
+        {
+            sizeof (MyAtkTableCellClass),
+            NULL,   /* base_init */
+            NULL,   /* base_finalize */
+            my_atk_table_cell_class_init, /* class_init */
+            NULL,   /* class_finalize */
+            NULL,   /* class_data */
+            sizeof (MyAtkTableCell),
+            0,      /* n_preallocs */
+            table_cell_instance_init    /* instance_init */
+        };
+        type = g_type_register_static (MY_TYPE_ATK_OBJECT,
+                                       "MyAtkTableCellType",
+                                       &info, 0);
+    }
+    return type;
+}
@@ -2,9 +2,9 @@
 #define MY_ATK_TABLE_H
 
 #include <glib-object.h>
-#include <atk/atk.h> 
+#include <atk/atk.h>
 #include <my-atk-object.h>
-    
+
 #define MY_TYPE_ATK_TABLE             (my_atk_table_get_type ())
 #define MY_ATK_TABLE(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), MY_TYPE_ATK_TABLE, MyAtkTable))
 #define MY_ATK_TABLE_CLASS(vtable)    (G_TYPE_CHECK_CLASS_CAST ((vtable), MY_TYPE_ATK_TABLE, MyAtkTableClass))
@@ -12,75 +12,103 @@
 #define MY_IS_ATK_TABLE_CLASS(vtable) (G_TYPE_CHECK_CLASS_TYPE ((vtable), MY_TYPE_ATK_TABLE))
 #define MY_ATK_TABLE_GET_CLASS(inst)  (G_TYPE_INSTANCE_GET_CLASS ((inst), MY_TYPE_ATK_TABLE, MyAtkTableClass))
 
-#define NROWS 4     /* row count */
-#define NCOLS 5     /* column count */
-
-static gint ids[NROWS][NCOLS] = 
-    { {0,  1,  2,  2,  3},
-      {4,  5,  6,  7,  8},
-      {9,  9, 10, 11, 12},
-      {9,  9, 13, 14, -1} };
-      
-static gint row_ext[NROWS][NCOLS] = 
-    { {1,  1,  1,  1,  1},
-      {1,  1,  1,  1,  1},
-      {2,  2,  1,  1,  1},
-      {2,  2,  1,  1,  1} };
-
-static gint col_ext[NROWS][NCOLS] = 
-    { {1,  1,  2,  2,  1},
-      {1,  1,  1,  1,  1},
-      {2,  2,  1,  1,  1},
-      {2,  2,  1,  1,  1} };
-
-#define NCHILDREN 16    /* child object count */
+#define MY_TYPE_ATK_TABLE_CELL        (my_atk_table_cell_get_type ())
+#define MY_ATK_TABLE_CELL(obj)        (G_TYPE_CHECK_INSTANCE_CAST ((obj), MY_TYPE_ATK_TABLE_CELL, MyAtkTableCell))
+#define MY_IS_ATK_TABLE_CELL(obj)     (G_TYPE_CHECK_INSTANCE_TYPE ((obj), MY_TYPE_ATK_TABLE_CELL))
+
+#define NROWS 4     /* default row count */
+#define NCOLS 5     /* default column count */
 
 // default string values
 #define DEF_CAPTION_TEXT    "Default table caption"
 #define DEF_SUMMARY_TEXT    "Default table summary"
 #define DEF_ROW_DESCR_TPL   "Row No%d"
 #define DEF_COL_DESCR_TPL   "Column No%d"
+#define DEF_CELL_NAME_TPL   "Cell %d,%d"
 
-/* row and column headers */
-typedef struct
-{
-    AtkObject* hdr;
-    gboolean selected;  /* TRUE if the row/column is selected, FALSE otherwise */
-} TestSimpleHeaderStruct;
-
-/* This struct represents a table cell */
+/* A cell spanning several rows or columns */
 typedef struct
 {
-    MyAtkObject* elem;   /* the element */
-    guint ext_row;           /* its row extent */
-    guint ext_col;           /* its column extent */
-} TestSimpleCell;
+    gint row;
+    gint column;
+    gint n_rows;
+    gint n_columns;
+} TableSpan;
 
 typedef struct _MyAtkTable MyAtkTable;
 typedef struct _MyAtkTableClass MyAtkTableClass;
+typedef struct _MyAtkTableCell MyAtkTableCell;
+typedef struct _MyAtkTableCellClass MyAtkTableCellClass;
 
-struct _MyAtkTable 
+/*
+ * The cells of the table are its children, in row-major order of their
+ * top-left corners. Cell objects are only created when they are first
+ * requested, so the size of the table is limited by the number of cells
+ * used rather than by the number of rows.
+ */
+struct _MyAtkTable
 {
     MyAtkObject parent;
-        
+
     gboolean disposed;
-    
-    MyAtkObject* child[NCHILDREN];
-    MyAtkObject* not_a_child;
-    TestSimpleHeaderStruct row[NROWS];
-    TestSimpleHeaderStruct col[NCOLS];
-    guint nrows;
-    guint ncols;
+
+    gint nrows;
+    gint ncols;
+    /* spanning cells (TableSpan*), sorted by row-major position of their
+     * corner; cells of one row and column are not stored */
+    GPtrArray* spans;
+    /* spans covering each row (GPtrArray of TableSpan*, sorted by column),
+     * by row; rows without spans have no entry */
+    GHashTable* row_spans;
+    /* number of grid positions covered by spans, other than their corners */
+    gint n_hidden;
+    /* cells created so far, by child index */
+    GHashTable* cells;
+    /* selected rows and columns, one bit each */
+    gulong* selected_rows;
+    gulong* selected_cols;
+    /* headers and descriptions set or requested so far, by row/column */
+    GHashTable* row_headers;
+    GHashTable* col_headers;
+    GHashTable* row_descriptions;
+    GHashTable* col_descriptions;
     AtkObject* caption;
     AtkObject* summary;
 };
 
-struct _MyAtkTableClass 
+struct _MyAtkTableClass
 {
     MyAtkObjectClass parent;
 };
 
-GType 
+struct _MyAtkTableCell
+{
+    MyAtkObject parent;
+
+    gint index;     /* child index in the table */
+};
+
+struct _MyAtkTableCellClass
+{
+    MyAtkObjectClass parent;
+};
+
+GType
 my_atk_table_get_type (void);
 
+GType
+my_atk_table_cell_get_type (void);
+
+void
+my_atk_table_set_size (MyAtkTable* table, gint nrows, gint ncols);
+
+gboolean
+my_atk_table_set_span (MyAtkTable* table, gint row, gint column, gint n_rows, gint n_columns);
+
+void
+my_atk_table_select_rows (MyAtkTable* table, gboolean sel_scheme[]);
+
+void
+my_atk_table_select_columns (MyAtkTable* table, gboolean sel_scheme[]);
+
 #endif /*MY_ATK_TABLE_H*/
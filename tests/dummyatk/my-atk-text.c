@@ -2,6 +2,9 @@
 #include <atk/atk.h>
 #include <string.h>
 #include <limits.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include <useful_functions.h>
 
 #include "my-atk-text.h"
@@ -65,77 +68,506 @@ static gboolean *tables[7]={NULL,
     table_line_symbols
     };
 
-static gboolean current_token(const gchar* str, gint offset, gint *token_start, gint *token_end,
+//Returns TRUE if character, starting at 'offset' byte of 'str', is a token symbol.
+//Tables classify ASCII symbols; bytes of other characters are marked as symbols
+//in all tables except the word one, so only words need unicode classification.
+static gboolean is_token_symbol(const gchar *str, gint offset,
     const gboolean table_token_symbols[TABLE_SIZE])
 {
-    const gchar *current = str + offset;
-    if(!table_token_symbols[(guchar)*current])
+    guchar c = (guchar)str[offset];
+    if(c < 0x80 || table_token_symbols != table_word_symbols)
+        return table_token_symbols[c];
+    return g_unichar_isalnum(g_utf8_get_char(str + offset));
+}
+#ifdef __SSE2__
+//Classifies 16 bytes at once: returns mask with bits set for bytes, which are
+//token symbols according to the table(non-ASCII bytes are never word symbols here).
+static guint token_symbols_mask(__m128i bytes, const gboolean table_token_symbols[TABLE_SIZE])
+{
+    __m128i stop;
+    if(table_token_symbols == table_word_symbols)
+    {
+        __m128i lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('0' - 1)),
+            _mm_cmplt_epi8(bytes, _mm_set1_epi8('9' + 1)));
+        __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+            _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+        return (guint)_mm_movemask_epi8(_mm_or_si128(digit, letter));
+    }
+    if(table_token_symbols == table_sentence_symbols)
+    {
+        //bytes >= 0x80 are negative, but they aren't control symbols
+        __m128i control = _mm_andnot_si128(_mm_cmplt_epi8(bytes, _mm_setzero_si128()),
+            _mm_cmplt_epi8(bytes, _mm_set1_epi8(0x20)));
+        stop = _mm_or_si128(control,
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('.')),
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('!')),
+                _mm_cmpeq_epi8(bytes, _mm_set1_epi8('?')))));
+    }
+    else
+    {
+        stop = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')),
+            _mm_cmpeq_epi8(bytes, _mm_setzero_si128()));
+    }
+    return (guint)_mm_movemask_epi8(stop) ^ 0xFFFF;
+}
+#endif /*__SSE2__*/
+/*
+ * Returns byte offset of the first character at or after 'offset', for which
+ * is_token_symbol() isn't equal to 'is_symbol'. If there is no such character,
+ * returns 'length'. 'offset' should be the start of a character.
+ */
+static gint skip_forward(const gchar *str, gint length, gint offset,
+    const gboolean table_token_symbols[TABLE_SIZE], gboolean is_symbol)
+{
+    while(offset < length)
+    {
+#ifdef __SSE2__
+        if(offset + 16 <= length)
+        {
+            __m128i bytes = _mm_loadu_si128((const __m128i*)(str + offset));
+            guint stop = token_symbols_mask(bytes, table_token_symbols) ^ (is_symbol ? 0xFFFF : 0);
+            if(table_token_symbols == table_word_symbols)
+                stop |= (guint)_mm_movemask_epi8(bytes);//check them by scalar code
+            if(stop == 0)
+            {
+                offset += 16;
+                continue;
+            }
+            //all bytes before stop are ASCII, so stop is the start of a character
+            offset += g_bit_nth_lsf(stop, -1);
+        }
+#endif /*__SSE2__*/
+        if(is_token_symbol(str, offset, table_token_symbols) != is_symbol)
+            return offset;
+        offset = g_utf8_next_char(str + offset) - str;
+    }
+    return length;
+}
+/*
+ * Returns byte offset of the last character at or before 'offset', for which
+ * is_token_symbol() isn't equal to 'is_symbol'. If there is no such character,
+ * returns -1. 'offset' should be the start of a character.
+ */
+static gint skip_backward(const gchar *str, gint offset,
+    const gboolean table_token_symbols[TABLE_SIZE], gboolean is_symbol)
+{
+    while(offset >= 0)
+    {
+#ifdef __SSE2__
+        if(offset >= 15)
+        {
+            __m128i bytes = _mm_loadu_si128((const __m128i*)(str + offset - 15));
+            guint stop = token_symbols_mask(bytes, table_token_symbols) ^ (is_symbol ? 0xFFFF : 0);
+            if(table_token_symbols == table_word_symbols)
+                stop |= (guint)_mm_movemask_epi8(bytes);
+            offset += (stop == 0) ? -16 : g_bit_nth_msf(stop, -1) - 15;
+            //new offset may be in the middle of a non-ASCII character
+            while(offset > 0 && ((guchar)str[offset] & 0xC0) == 0x80) offset--;
+            if(stop == 0) continue;
+        }
+#endif /*__SSE2__*/
+        if(is_token_symbol(str, offset, table_token_symbols) != is_symbol)
+            return offset;
+        do offset--; while(offset > 0 && ((guchar)str[offset] & 0xC0) == 0x80);
+    }
+    return -1;
+}
+//Token functions work with byte offsets in 'str' of 'length' bytes.
+static gboolean current_token(const gchar* str, gint length, gint offset,
+    gint *token_start, gint *token_end, const gboolean table_token_symbols[TABLE_SIZE])
+{
+    if(!is_token_symbol(str, offset, table_token_symbols))
     {
         return FALSE;
     }
-    for( --current; (current >= str) && table_token_symbols[(guchar)*current]; --current);
-    *token_start = current - str + 1;
-    for(current = str + offset + 1;
-        (*current != 0) && table_token_symbols[(guchar)*current]; ++current);
-    *token_end = current - str;
+    gint previous = skip_backward(str, offset, table_token_symbols, TRUE);
+    *token_start = (previous < 0) ? 0 : g_utf8_next_char(str + previous) - str;
+    *token_end = skip_forward(str, length, offset, table_token_symbols, TRUE);
     return TRUE;
 }
-static gboolean next_token(const gchar* str, gint offset, gint *token_start, gint *token_end,
-    const gboolean table_token_symbols[TABLE_SIZE])
+static gboolean next_token(const gchar* str, gint length, gint offset,
+    gint *token_start, gint *token_end, const gboolean table_token_symbols[TABLE_SIZE])
 {
-    const gchar *current = str + offset;
-    for( ; (*current != 0) && table_token_symbols[(guchar)*current]; ++current);
-    if(*current == 0)
+    gint current = skip_forward(str, length, offset, table_token_symbols, TRUE);
+    if(current >= length)
         return FALSE;
-    for(++current ; (*current != 0) && !table_token_symbols[(guchar)*current]; ++current);
-    if(!table_token_symbols[(guchar)*current])
+    current = skip_forward(str, length, current, table_token_symbols, FALSE);
+    if(current >= length)
         return FALSE;
-    return current_token(str, current - str, token_start, token_end, table_token_symbols);
+    return current_token(str, length, current, token_start, token_end, table_token_symbols);
 }
-static gboolean previous_token(const gchar* str, gint offset, gint *token_start, gint *token_end,
-    const gboolean table_token_symbols[TABLE_SIZE])
+static gboolean previous_token(const gchar* str, gint length, gint offset,
+    gint *token_start, gint *token_end, const gboolean table_token_symbols[TABLE_SIZE])
 {
-    const gchar *current = str + offset;
-    for( ; (current > str) && table_token_symbols[(guchar)*current]; --current);
-    if(current == str)
+    gint current = skip_backward(str, offset, table_token_symbols, TRUE);
+    if(current <= 0)
         return FALSE;
-    for( ; (current > str) && !table_token_symbols[(guchar)*current]; --current);
-    if(!table_token_symbols[(guchar)*current])
+    current = skip_backward(str, current, table_token_symbols, FALSE);
+    if(current < 0)
         return FALSE;
-    return current_token(str, current - str, token_start, token_end, table_token_symbols);
+    return current_token(str, length, current, token_start, token_end, table_token_symbols);
 }
 
 
-//Range: type of data, containing in list of attributes
+//Interned attribute set: ranges with equal attributes share one copy of them
+typedef struct
+{
+    AtkAttributeSet *attributeSet;
+    gchar *key;//canonical representation of the set, key in MyAtkText::attribute_sets
+    gint ref_count;
+} SharedAttributeSet;
+
+static gint attribute_compare(gconstpointer a, gconstpointer b)
+{
+    const AtkAttribute *attr1 = *(AtkAttribute* const*)a;
+    const AtkAttribute *attr2 = *(AtkAttribute* const*)b;
+    gint result = strcmp(attr1->name, attr2->name);
+    return result ? result : strcmp(attr1->value, attr2->value);
+}
+//returns newly allocated string, which is equal for sets with the same attributes
+//(order of attributes in the list doesn't matter)
+static gchar* attribute_set_key(AtkAttributeSet *set)
+{
+    GSList *tmp;
+    guint i;
+    GString *key = g_string_new(NULL);
+    GPtrArray *attrs = g_ptr_array_sized_new(g_slist_length(set));
+    for(tmp = set; tmp != NULL; tmp = tmp->next)
+        g_ptr_array_add(attrs, tmp->data);
+    g_ptr_array_sort(attrs, attribute_compare);
+    //lengths are written before strings, so names and values may contain any symbols
+    for(i = 0; i < attrs->len; i++)
+    {
+        AtkAttribute *attr = (AtkAttribute*)g_ptr_array_index(attrs, i);
+        g_string_append_printf(key, "%d:%s%d:%s",
+            (gint)strlen(attr->name), attr->name, (gint)strlen(attr->value), attr->value);
+    }
+    g_ptr_array_free(attrs, TRUE);
+    return g_string_free(key, FALSE);
+}
+static void shared_attribute_set_free(SharedAttributeSet *shared)
+{
+    atk_attribute_set_free(shared->attributeSet);
+    g_free(shared->key);
+    g_free(shared);
+}
+//returns interned copy of 'set' with incremented reference count
+static SharedAttributeSet* attribute_set_intern(GHashTable *attribute_sets, AtkAttributeSet *set)
+{
+    gchar *key = attribute_set_key(set);
+    SharedAttributeSet *shared = g_hash_table_lookup(attribute_sets, key);
+    if(shared != NULL)
+    {
+        g_free(key);
+        shared->ref_count++;
+        return shared;
+    }
+    shared = g_malloc(sizeof(SharedAttributeSet));
+    shared->attributeSet = attribute_set_copy(set);
+    shared->key = key;
+    shared->ref_count = 1;
+    g_hash_table_insert(attribute_sets, key, shared);
+    return shared;
+}
+static void attribute_set_release(GHashTable *attribute_sets, SharedAttributeSet *shared)
+{
+    if(--shared->ref_count == 0)
+        g_hash_table_remove(attribute_sets, shared->key);//frees 'shared'
+}
+
+//Range: element of the sorted array of run attributes
 typedef struct
 {
     gint start,end;//range, containing this attributes
-    AtkAttributeSet* attributeSet;
+    SharedAttributeSet* attributes;
 } Range;
 //auxiliary functions for ranges
-Range* range_new(gint start, gint end)
+void range_print(const Range*range)
 {
-    Range *range = g_malloc(sizeof(Range));
-    range->start = start;
-    range->end = end;
-    range->attributeSet = NULL;
-    return range;
+    TRACE("[%d,%d):", range->start, range->end);
+    attribute_set_print(range->attributes->attributeSet);
+}
+//Ranges in the array are sorted and don't intersect, so their ends are sorted too.
+//Returns index of the first range with end > offset (ranges->len, if there is no such range).
+static guint range_array_search(GArray *ranges, gint offset)
+{
+    guint low = 0, high = ranges->len;
+    while(low < high)
+    {
+        guint middle = low + (high - low) / 2;
+        if(g_array_index(ranges, Range, middle).end <= offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+//releases attributes of ranges [index, index + length) and removes them from the array
+static void range_array_remove(MyAtkText *text, guint index, guint length)
+{
+    guint i;
+    if(length == 0) return;
+    for(i = index; i < index + length; i++)
+        attribute_set_release(text->attribute_sets,
+            g_array_index(text->attributes, Range, i).attributes);
+    g_array_remove_range(text->attributes, index, length);
+}
+//shifts ranges, which begin from index, on 'delta' symbols
+static void range_array_shift(GArray *ranges, guint index, gint delta)
+{
+    Range *range = (Range*)ranges->data;
+    guint i;
+    for(i = index; i < ranges->len; i++)
+    {
+        range[i].start += delta;
+        range[i].end += delta;
+    }
 }
+//Text buffer
+//Minimal size of the gap, allocated when buffer grows
+#define TEXT_BUFFER_MIN_GAP 64
+//Number of characters between checkpoints of the character offsets map
+#define TEXT_BUFFER_CHECKPOINT_STEP 32
+static void text_buffer_init(TextBuffer *buffer)
+{
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->gap_start = 0;
+    buffer->gap_end = 0;
+    buffer->char_length = 0;
+    buffer->checkpoints = NULL;
+}
+static void text_buffer_free(TextBuffer *buffer)
+{
+    g_free(buffer->data);
+    g_free(buffer->checkpoints);
+    text_buffer_init(buffer);
+}
+static gint text_buffer_length(const TextBuffer *buffer)
+{
+    return buffer->size - (buffer->gap_end - buffer->gap_start);
+}
+//moves gap, so that it starts at 'position'
+static void text_buffer_move_gap(TextBuffer *buffer, gint position)
+{
+    gint gap_size = buffer->gap_end - buffer->gap_start;
+    if(position < buffer->gap_start)
+        memmove(buffer->data + position + gap_size, buffer->data + position,
+            (size_t)(buffer->gap_start - position));
+    else if(position > buffer->gap_start)
+        memmove(buffer->data + buffer->gap_start, buffer->data + buffer->gap_end,
+            (size_t)(position - buffer->gap_start));
+    buffer->gap_start = position;
+    buffer->gap_end = position + gap_size;
+}
+//ensures that gap is at least 'length' bytes long(grows storage geometrically)
+static void text_buffer_reserve(TextBuffer *buffer, gint length)
+{
+    if(buffer->gap_end - buffer->gap_start >= length) return;
+    gint tail_length = buffer->size - buffer->gap_end;
+    gint new_size = MAX(buffer->size * 2,
+        text_buffer_length(buffer) + length + TEXT_BUFFER_MIN_GAP);
 
-void range_free(Range* range)
+    buffer->data = g_realloc(buffer->data, new_size);
+    if(tail_length != 0)
+        memmove(buffer->data + new_size - tail_length, buffer->data + buffer->gap_end,
+            (size_t)tail_length);
+    buffer->gap_end = new_size - tail_length;
+    buffer->size = new_size;
+}
+static void text_buffer_insert(TextBuffer *buffer, gint position, const gchar *string, gint length)
 {
-    atk_attribute_set_free(range->attributeSet);
-    g_free(range);
+    //one more byte for terminating '\0' in text_buffer_get_contents()
+    text_buffer_reserve(buffer, length + 1);
+    text_buffer_move_gap(buffer, position);
+    memcpy(buffer->data + buffer->gap_start, string, (size_t)length);
+    buffer->gap_start += length;
+    buffer->char_length = -1;
 }
-void range_print(const Range*range)
+static void text_buffer_delete(TextBuffer *buffer, gint start, gint end)
 {
-    TRACE("[%d,%d):", range->start, range->end);
-    attribute_set_print(range->attributeSet);
+    text_buffer_move_gap(buffer, start);
+    buffer->gap_end += end - start;
+    buffer->char_length = -1;
+}
+static gchar text_buffer_get_char(const TextBuffer *buffer, gint offset)
+{
+    if(offset < buffer->gap_start) return buffer->data[offset];
+    return buffer->data[offset + buffer->gap_end - buffer->gap_start];
+}
+//returns newly allocated copy of [start, end) range of text. Gap isn't moved.
+static gchar* text_buffer_get_text(const TextBuffer *buffer, gint start, gint end)
+{
+    gchar *result = g_malloc(end - start + 1);
+    gchar *dest = result;
+    result[end - start] = '\0';
+    if(start < buffer->gap_start)
+    {
+        gint length = MIN(end, buffer->gap_start) - start;
+        memcpy(dest, buffer->data + start, (size_t)length);
+        dest += length;
+        start += length;
+    }
+    if(start < end)
+        memcpy(dest, buffer->data + start + buffer->gap_end - buffer->gap_start,
+            (size_t)(end - start));
+    return result;
+}
+/*
+ * Returns contiguous '\0'-terminated text, which is valid until next modification
+ * of the buffer. Gap is moved to the end of the text, so next calls are cheap
+ * until the text is edited again.
+ */
+static const gchar* text_buffer_get_contents(TextBuffer *buffer)
+{
+    if(buffer->data == NULL) return "";
+    text_buffer_move_gap(buffer, text_buffer_length(buffer));
+    buffer->data[buffer->gap_start] = '\0';
+    return buffer->data;
+}
+//checks, that 'length' bytes of 'str' are ASCII symbols
+static gboolean text_is_ascii(const gchar *str, gint length)
+{
+    gint i = 0;
+#ifdef __SSE2__
+    for(; i + 16 <= length; i += 16)
+        if(_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(str + i))) != 0)
+            return FALSE;
+#endif /*__SSE2__*/
+    for(; i < length; i++)
+        if((guchar)str[i] >= 0x80) return FALSE;
+    return TRUE;
+}
+//rebuilds map between character and byte offsets, if the text was modified
+static void text_buffer_update_index(TextBuffer *buffer)
+{
+    if(buffer->char_length >= 0) return;
+    gint gap_size = buffer->gap_end - buffer->gap_start;
+    gint length = text_buffer_length(buffer);
+    g_free(buffer->checkpoints);
+    buffer->checkpoints = NULL;
+    if(text_is_ascii(buffer->data, buffer->gap_start)
+        && text_is_ascii(buffer->data + buffer->gap_end, length - buffer->gap_start))
+    {
+        buffer->char_length = length;
+        return;
+    }
+    gint i, n_chars = 0;
+    buffer->checkpoints = g_malloc(sizeof(gint) * (length / TEXT_BUFFER_CHECKPOINT_STEP + 2));
+    for(i = 0; i < length; i++)
+    {
+        guchar c = (guchar)buffer->data[i < buffer->gap_start ? i : i + gap_size];
+        if((c & 0xC0) == 0x80) continue;//not the first byte of a character
+        if(n_chars % TEXT_BUFFER_CHECKPOINT_STEP == 0)
+            buffer->checkpoints[n_chars / TEXT_BUFFER_CHECKPOINT_STEP] = i;
+        n_chars++;
+    }
+    if(n_chars % TEXT_BUFFER_CHECKPOINT_STEP == 0)
+        buffer->checkpoints[n_chars / TEXT_BUFFER_CHECKPOINT_STEP] = length;
+    buffer->char_length = n_chars;
 }
-//only for correct list of ranges - ranges shouldn't intersect
-gint range_compare(const Range* range1, const Range* range2)
+static gint text_buffer_char_count(TextBuffer *buffer)
 {
-    return range1->start - range2->start;//never equal
+    text_buffer_update_index(buffer);
+    return buffer->char_length;
+}
+//converts character offset to byte one(offsets after the end are shifted as is)
+static gint text_buffer_byte_offset(TextBuffer *buffer, gint offset)
+{
+    text_buffer_update_index(buffer);
+    if(buffer->checkpoints == NULL || offset <= 0) return offset;
+    if(offset > buffer->char_length)
+        return text_buffer_length(buffer) + offset - buffer->char_length;
+    gint length = text_buffer_length(buffer);
+    gint result = buffer->checkpoints[offset / TEXT_BUFFER_CHECKPOINT_STEP];
+    for(offset %= TEXT_BUFFER_CHECKPOINT_STEP; offset > 0; offset--)
+    {
+        do result++;
+        while(result < length && (text_buffer_get_char(buffer, result) & 0xC0) == 0x80);
+    }
+    return result;
+}
+//converts byte offset of the start of a character to character offset
+static gint text_buffer_char_offset(TextBuffer *buffer, gint offset)
+{
+    text_buffer_update_index(buffer);
+    if(buffer->checkpoints == NULL || offset <= 0) return offset;
+    gint length = text_buffer_length(buffer);
+    if(offset > length) return buffer->char_length + offset - length;
+    //last checkpoint before offset
+    gint low = 0, high = buffer->char_length / TEXT_BUFFER_CHECKPOINT_STEP;
+    while(low < high)
+    {
+        gint middle = (low + high + 1) / 2;
+        if(buffer->checkpoints[middle] <= offset) low = middle;
+        else high = middle - 1;
+    }
+    gint i, result = low * TEXT_BUFFER_CHECKPOINT_STEP;
+    for(i = buffer->checkpoints[low]; i < offset; i++)
+        if((text_buffer_get_char(buffer, i) & 0xC0) != 0x80) result++;
+    return result;
+}
+//returns unicode character, starting at 'offset' byte
+static gunichar text_buffer_get_unichar(TextBuffer *buffer, gint offset)
+{
+    gchar utf8[7];
+    gint i, length = text_buffer_length(buffer);
+    utf8[0] = text_buffer_get_char(buffer, offset);
+    for(i = 1; i < g_utf8_skip[(guchar)utf8[0]] && offset + i < length; i++)
+        utf8[i] = text_buffer_get_char(buffer, offset + i);
+    utf8[i] = '\0';
+    return g_utf8_get_char(utf8);
+}
+/*
+ * Token functions for the text of MyAtkText in character offsets.
+ * Boundaries are searched in bytes of the contiguous text, so offsets are converted
+ * only for the found tokens(conversion is trivial for ASCII text).
+ */
+typedef struct
+{
+    TextBuffer *buffer;
+    const gchar *str;
+    gint length;//in bytes
+} TextView;
+static void text_view_init(TextView *view, TextBuffer *buffer)
+{
+    view->buffer = buffer;
+    view->str = text_buffer_get_contents(buffer);
+    view->length = text_buffer_length(buffer);
+}
+//converts result of the token function from bytes to characters
+static gboolean text_view_token(const TextView *view, gboolean found,
+    gint start, gint end, gint *token_start, gint *token_end)
+{
+    if(!found) return FALSE;
+    *token_start = text_buffer_char_offset(view->buffer, start);
+    *token_end = text_buffer_char_offset(view->buffer, end);
+    return TRUE;
+}
+static gboolean text_view_current_token(const TextView *view, gint offset,
+    gint *token_start, gint *token_end, const gboolean table_token_symbols[TABLE_SIZE])
+{
+    gint start, end;
+    gboolean found = current_token(view->str, view->length,
+        text_buffer_byte_offset(view->buffer, offset), &start, &end, table_token_symbols);
+    return text_view_token(view, found, start, end, token_start, token_end);
+}
+static gboolean text_view_next_token(const TextView *view, gint offset,
+    gint *token_start, gint *token_end, const gboolean table_token_symbols[TABLE_SIZE])
+{
+    gint start, end;
+    gboolean found = next_token(view->str, view->length,
+        text_buffer_byte_offset(view->buffer, offset), &start, &end, table_token_symbols);
+    return text_view_token(view, found, start, end, token_start, token_end);
+}
+static gboolean text_view_previous_token(const TextView *view, gint offset,
+    gint *token_start, gint *token_end, const gboolean table_token_symbols[TABLE_SIZE])
+{
+    gint start, end;
+    gboolean found = previous_token(view->str, view->length,
+        text_buffer_byte_offset(view->buffer, offset), &start, &end, table_token_symbols);
+    return text_view_token(view, found, start, end, token_start, token_end);
 }
 //Bounds of text
 void text_bounds_init(TextBounds *bounds)
@@ -167,16 +599,18 @@ gint get_character_line(MyAtkText *text, gint offset, gint *relative_offset)
 {
     gint result = 0;
     //simple realization - counts lines from start of the text, until reaches offset
-    const guchar *text_str = (guchar*)text->str; 
+    const guchar *text_str = (const guchar*)text_buffer_get_contents(&text->buffer);
+    gint byte_offset = text_buffer_byte_offset(&text->buffer, offset);
     gboolean state_FSM = table_line_symbols[text_str[0]];
     gint i, last_line_start = 0;
-    for(i = 1; i <= offset; state_FSM = table_line_symbols[text_str[i++]])
+    for(i = 1; i <= byte_offset; state_FSM = table_line_symbols[text_str[i++]])
     {
         if(state_FSM)continue;
         result++;
         last_line_start = i;
     }
-    if(relative_offset != NULL) *relative_offset = offset - last_line_start;
+    if(relative_offset != NULL)
+        *relative_offset = offset - text_buffer_char_offset(&text->buffer, last_line_start);
     return result;
 }
 // Compute extent of character,
@@ -214,16 +648,16 @@ gint get_offset_at_line_start(MyAtkText *text, gint line)
     gint i;
     if(line < 0)return -1;
     if(line == 0)return 0;
-    gint len = my_strlen(text->str);
-    guchar *str = (guchar*)text->str;
+    gint len = text_buffer_length(&text->buffer);
+    const guchar *str = (const guchar*)text_buffer_get_contents(&text->buffer);
     gint current_line = 0;
     gboolean state_FSM = table_line_symbols[str[0]];
     for(i = 1; i < len; state_FSM = table_line_symbols[str[i++]])
     {
         if(state_FSM || ++current_line != line)continue;
-        return i;
+        return text_buffer_char_offset(&text->buffer, i);
     }
-    return len;
+    return text_buffer_char_count(&text->buffer);
     
 }
 // Return offset of character at the given line and at the given offset at this line
@@ -232,12 +666,14 @@ gint get_offset_at_line(MyAtkText *text, gint line, gint relative_offset)
 {
     gint j;
     if(line < 0 || relative_offset < 0)return -1; 
-    const guchar* str = (guchar*)text->str;
-    gint len = my_strlen(text->str);
+    const guchar* str = (const guchar*)text_buffer_get_contents(&text->buffer);
+    gint len = text_buffer_char_count(&text->buffer);
     gint offset_at_line_start = get_offset_at_line_start(text, line);
     if(offset_at_line_start + relative_offset >= len)return -1;
-    for(j = 0; j <= relative_offset; j++) 
-        if(!table_line_symbols[str[offset_at_line_start + j]])
+    //non-ASCII characters never break lines, so it is sufficient to check bytes
+    gint end_byte = text_buffer_byte_offset(&text->buffer, offset_at_line_start + relative_offset);
+    for(j = text_buffer_byte_offset(&text->buffer, offset_at_line_start); j <= end_byte; j++) 
+        if(!table_line_symbols[str[j]])
             return -1;
     return offset_at_line_start + relative_offset;
 }
@@ -250,15 +686,15 @@ gint get_offset_at_line(MyAtkText *text, gint line, gint relative_offset)
 gint count_ranges(MyAtkText *text, gint offset, gint rel_start_offset, gint rel_end_offset, 
                  gint number_of_lines, AtkTextRange** ranges, AtkCoordType coord_type)
 {
-    guchar *str = (guchar*)text->str;
-    gint len = my_strlen(text->str);
+    const guchar *str = (const guchar*)text_buffer_get_contents(&text->buffer);
+    gint len = text_buffer_char_count(&text->buffer);
     
     gint number_of_ranges = 0;
     gint current_line = 0;
     gint current_line_start = offset;
     for(;(current_line < number_of_lines) && (current_line_start < len); current_line ++)
     {
-        if(!table_line_symbols[str[current_line_start]])
+        if(!table_line_symbols[str[text_buffer_byte_offset(&text->buffer, current_line_start)]])
         {
             current_line_start++;
             continue;
@@ -290,9 +726,7 @@ gint count_ranges(MyAtkText *text, gint offset, gint rel_start_offset, gint rel_
 //"free"-functions(for internal using, because them don't emit signals)
 void my_atk_text_free_run_attributes(MyAtkText *text)
 {
-    g_list_foreach(text->attributes, (GFunc)range_free, NULL);
-    g_list_free(text->attributes);
-    text->attributes = NULL;
+    range_array_remove(text, 0, text->attributes->len);
 }
 void my_atk_text_free_default_attributes(MyAtkText *text)
 {
@@ -326,115 +760,116 @@ void table_symbols_init()
     table_line_symbols['\n'] = FALSE;
     table_line_symbols['\0'] = FALSE;
 }
+//Selections are sorted and don't intersect, so their ends are sorted too.
+//Returns index of the first selection with end_offset > offset.
+static guint selection_search(GArray *selections, gint offset)
+{
+    guint low = 0, high = selections->len;
+    while(low < high)
+    {
+        guint middle = low + (high - low) / 2;
+        if(g_array_index(selections, TextSelection, middle).end_offset <= offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+//shifts selections, which begin from index, on 'delta' symbols
+static void selection_array_shift(GArray *selections, guint index, gint delta)
+{
+    TextSelection *sel = (TextSelection*)selections->data;
+    guint i;
+    for(i = index; i < selections->len; i++)
+    {
+        sel[i].start_offset += delta;
+        sel[i].end_offset += delta;
+    }
+}
 void correct_selections_after_insert(MyAtkText *text, gint position, gint length)
 {
-    gint i;
     GArray* selections = text->selections;
-    for(i = selections->len - 1; i >=0; i--)
+    //selections, which end at inserted position, are enlarged too
+    guint i = selection_search(selections, position - 1);
+    if(i < selections->len)
     {
         TextSelection* sel  = &g_array_index(selections, TextSelection, i);
-        if(sel->end_offset >= position) sel->end_offset+= length;
-        if(sel->start_offset >= position) sel->start_offset+= length;
-        else break;
+        if(sel->start_offset < position)
+        {
+            sel->end_offset += length;
+            i++;
+        }
     }
+    selection_array_shift(selections, i, length);
 }
 void correct_selections_after_delete(MyAtkText *text, gint position, gint length)
 {
-    gint i;
     GArray* selections = text->selections;
-    for(i = selections->len - 1; i >=0; i--)
+    guint i = selection_search(selections, position), j;
+    if(i < selections->len)
     {
         TextSelection* sel  = &g_array_index(selections, TextSelection, i);
-        if(sel->start_offset >= position)
+        /*sel->start_offset < position*/
+        if(sel->start_offset < position)
         {
-             if(sel->start_offset >= position + length)
-             {
-                sel->start_offset-= length;
-                sel->end_offset-= length;
-             }
-             //position <= sel->start_offset < position + length
-             else if(sel->end_offset > position + length)
-             {
-                sel->start_offset = position;
-                sel->end_offset -= length;
-             }
-             else
-             {
-                g_array_remove_index(selections, i);
-             }
-             continue;  
+            if(sel->end_offset > position + length) sel->end_offset-= length;
+            else sel->end_offset = position;
+            i++;
         }
-        /*sel->start_offset < position*/
-        if(sel->end_offset > position + length) sel->end_offset-= length;
-        else if(sel->end_offset > position) sel->end_offset = position;
-        break;
     }
+    //selections, started in deleted range, are removed or cut
+    for(j = i; j < selections->len; j++)
+    {
+        TextSelection* sel  = &g_array_index(selections, TextSelection, j);
+        if(sel->start_offset >= position + length) break;
+        if(sel->end_offset > position + length)
+        {
+            sel->start_offset = position + length;//will be restored in the shift
+            break;
+        }
+    }
+    if(j > i) g_array_remove_range(selections, i, j - i);
+    selection_array_shift(selections, i, -length);
 }
 void correct_attributes_after_insert(MyAtkText* text, gint position, gint length)
 {
-    GList *attributes = text->attributes;
-    GList *tmp;
-    //before inserted position
-    for(tmp = attributes; tmp != NULL; tmp = tmp -> next)
-    {
-        Range* range = (Range*)tmp->data;
-        if(range->end <= position)continue;
-        //range->end > position
-        if(range->start < position)
-            range->start -= length;//will be restore in the next loop
-        break;
-    }
+    GArray *attributes = text->attributes;
+    guint i = range_array_search(attributes, position);
+    //range, containing inserted position, is enlarged
+    if(i < attributes->len && g_array_index(attributes, Range, i).start < position)
+        g_array_index(attributes, Range, i++).end += length;
     //after inserted position
-    for(; tmp != NULL; tmp = tmp -> next)
-    {
-        Range* range = (Range*)tmp->data;
-        range->end += length;
-        range->start += length;
-    }
+    range_array_shift(attributes, i, length);
 }
 void correct_attributes_after_delete(MyAtkText* text, gint position, gint length)
 {
-    GList *attributes = text->attributes;
-    GList *tmp = attributes;
+    GArray *attributes = text->attributes;
+    guint i = range_array_search(attributes, position), j;
     //before deleting range
-    for(tmp = attributes; tmp != NULL; tmp = tmp->next)
+    if(i < attributes->len)
     {
-        Range* range  = (Range*)tmp->data;
-        if(range->end <= position) continue;
+        Range* range = &g_array_index(attributes, Range, i);
         if(range->start < position)
         {
              if(range->end > position + length) range->end -= length;
              else range->end = position;
-             tmp = tmp->next;
+             i++;
         }
-        break;
     }
     //at deleting range
-    while(tmp != NULL)
+    for(j = i; j < attributes->len; j++)
     {
-        Range* range = (Range*)tmp->data;
+        Range* range = &g_array_index(attributes, Range, j);
         if(range->start >= position + length) break;
-        if(range->end <= position + length)
-        {
-            GList *tmp1 = tmp->next;
-            range_free(range);
-            attributes = g_list_remove_link(attributes, tmp);
-            tmp = tmp1;
-            continue;
-        }
+        if(range->end <= position + length) continue;
         //range->end > position + length
         //range->start < position + length
-        range->start = position + length;//will be restored in next loop
+        range->start = position + length;//will be restored in the shift
         break;
     }
+    range_array_remove(text, i, j - i);
     //after deleting range
-    for(;tmp != NULL; tmp = tmp->next)
-    {
-        Range* range = (Range*)tmp->data;
-        range->end -= length;
-        range->start -= length;
-    }
-    text->attributes = attributes;
+    range_array_shift(attributes, i, -length);
 }
 void correct_caret_after_insert(MyAtkText* text, gint position, gint length)
 {
@@ -451,29 +886,30 @@ void correct_caret_after_delete(MyAtkText* text, gint position, gint length)
 static gint my_atk_text_get_character_count(AtkText *text)
 {
     MyAtkText *self = (MyAtkText*)text;
-    return my_strlen(self->str);
+    return text_buffer_char_count(&self->buffer);
 }
 //**************************************my_atk_text_get_text*****************************
 static gchar* my_atk_text_get_text(AtkText *text, gint start_offset, gint end_offset)
 {
-    gchar *str = ((MyAtkText*)text)->str;
-    if((start_offset < 0) || (end_offset > my_strlen(str)) || (end_offset <= start_offset))
+    TextBuffer *buffer = &((MyAtkText*)text)->buffer;
+    if((start_offset < 0) || (end_offset > text_buffer_char_count(buffer)) || (end_offset <= start_offset))
     {
         //incorrect bounds
         return NULL;
     }
-    return g_strndup(str + start_offset, end_offset - start_offset);
+    return text_buffer_get_text(buffer, text_buffer_byte_offset(buffer, start_offset),
+        text_buffer_byte_offset(buffer, end_offset));
     
 }
 //*******************************my_atk_text_get_character_at_offset************************
 static gunichar my_atk_text_get_character_at_offset(AtkText *text, gint offset)
 {
-    gchar *str = ((MyAtkText*)text)->str;
-    if(offset < 0 || offset >= my_strlen(str))
+    TextBuffer *buffer = &((MyAtkText*)text)->buffer;
+    if(offset < 0 || offset >= text_buffer_char_count(buffer))
     {
         return 0;
     }
-    return (gunichar)str[offset];
+    return text_buffer_get_unichar(buffer, text_buffer_byte_offset(buffer, offset));
 }
 // In the next 3 functions some code is commented for verify tests themselves on 'mutants'
 // in realization.
@@ -481,8 +917,10 @@ static gunichar my_atk_text_get_character_at_offset(AtkText *text, gint offset)
 static gchar* my_atk_text_get_text_after_offset(AtkText *text, gint offset,
     AtkTextBoundary boundary_type, gint *start_offset, gint *end_offset)
 {
-    gchar *str = ((MyAtkText*)text)->str;
-    gint len = my_strlen(str);
+    TextBuffer *buffer = &((MyAtkText*)text)->buffer;
+    gint len = text_buffer_char_count(buffer);
+    TextView view;
+    text_view_init(&view, buffer);
     if((offset < 0) || (offset >= len))
     {
         return NULL;//incorrect offset
@@ -510,10 +948,10 @@ static gchar* my_atk_text_get_text_after_offset(AtkText *text, gint offset,
     case ATK_TEXT_BOUNDARY_WORD_START:
     case ATK_TEXT_BOUNDARY_SENTENCE_START:
     case ATK_TEXT_BOUNDARY_LINE_START:
-        if(!next_token(str, offset, start_offset, &end_tmp, tables[boundary_type]))
+        if(!text_view_next_token(&view, offset, start_offset, &end_tmp, tables[boundary_type]))
         {
             //debug
-//            if(current_token(str, offset, start_offset, end_offset, tables[boundary_type]))
+//            if(text_view_current_token(&view, offset, start_offset, end_offset, tables[boundary_type]))
 //            {
 //                is_successed = TRUE;
 //                break;
@@ -521,7 +959,7 @@ static gchar* my_atk_text_get_text_after_offset(AtkText *text, gint offset,
             is_successed = FALSE;
             break;
         }
-        if(!next_token(str, end_tmp, end_offset, &end_tmp, tables[boundary_type]))
+        if(!text_view_next_token(&view, end_tmp, end_offset, &end_tmp, tables[boundary_type]))
         {
             *end_offset = len;
         }
@@ -533,9 +971,9 @@ static gchar* my_atk_text_get_text_after_offset(AtkText *text, gint offset,
     case ATK_TEXT_BOUNDARY_WORD_END:
     case ATK_TEXT_BOUNDARY_SENTENCE_END:
     case ATK_TEXT_BOUNDARY_LINE_END:
-        if(!current_token(str, offset, &start_tmp, start_offset, tables[boundary_type]))
+        if(!text_view_current_token(&view, offset, &start_tmp, start_offset, tables[boundary_type]))
         {
-            if(!next_token(str, offset, &start_tmp, start_offset, tables[boundary_type]))
+            if(!text_view_next_token(&view, offset, &start_tmp, start_offset, tables[boundary_type]))
             {
                 is_successed = FALSE;
                 break;
@@ -548,7 +986,7 @@ static gchar* my_atk_text_get_text_after_offset(AtkText *text, gint offset,
 //            is_successed = TRUE;
 //           break;
 //        }
-        if(!next_token(str, *start_offset, &start_tmp, end_offset, tables[boundary_type]))
+        if(!text_view_next_token(&view, *start_offset, &start_tmp, end_offset, tables[boundary_type]))
         {
             is_successed = FALSE;
             break;
@@ -575,8 +1013,10 @@ static gchar* my_atk_text_get_text_after_offset(AtkText *text, gint offset,
 static gchar* my_atk_text_get_text_at_offset(AtkText *text, gint offset,
     AtkTextBoundary boundary_type, gint *start_offset, gint *end_offset)
 {
-    gchar *str = ((MyAtkText*)text)->str;
-    gint len = my_strlen(str);
+    TextBuffer *buffer = &((MyAtkText*)text)->buffer;
+    gint len = text_buffer_char_count(buffer);
+    TextView view;
+    text_view_init(&view, buffer);
     if((offset < 0) || (offset >= len))
     {
         return NULL;
@@ -599,15 +1039,15 @@ static gchar* my_atk_text_get_text_at_offset(AtkText *text, gint offset,
     case ATK_TEXT_BOUNDARY_WORD_START:
     case ATK_TEXT_BOUNDARY_SENTENCE_START:
     case ATK_TEXT_BOUNDARY_LINE_START:
-        if(!current_token(str, offset, start_offset, &end_tmp, tables[boundary_type]))
+        if(!text_view_current_token(&view, offset, start_offset, &end_tmp, tables[boundary_type]))
         {
-            if(!previous_token(str, offset, start_offset, &end_tmp, tables[boundary_type]))
+            if(!text_view_previous_token(&view, offset, start_offset, &end_tmp, tables[boundary_type]))
             {
                 is_successed = FALSE;
                 break;
             }
         }
-        if(!next_token(str, offset, end_offset, &end_tmp, tables[boundary_type]))
+        if(!text_view_next_token(&view, offset, end_offset, &end_tmp, tables[boundary_type]))
         {
             *end_offset = len;
         }
@@ -616,15 +1056,15 @@ static gchar* my_atk_text_get_text_at_offset(AtkText *text, gint offset,
     case ATK_TEXT_BOUNDARY_WORD_END:
     case ATK_TEXT_BOUNDARY_SENTENCE_END:
     case ATK_TEXT_BOUNDARY_LINE_END:
-        if(!current_token(str, offset, &start_tmp, end_offset, tables[boundary_type]))
+        if(!text_view_current_token(&view, offset, &start_tmp, end_offset, tables[boundary_type]))
         {
-            if(!next_token(str, offset, &start_tmp, end_offset, tables[boundary_type]))
+            if(!text_view_next_token(&view, offset, &start_tmp, end_offset, tables[boundary_type]))
             {
                 is_successed = FALSE;
                 break;
             }
         }
-        if(!previous_token(str, start_tmp, &start_tmp, start_offset, tables[boundary_type]))
+        if(!text_view_previous_token(&view, start_tmp, &start_tmp, start_offset, tables[boundary_type]))
         {
             *start_offset = 0;
         }
@@ -652,8 +1092,10 @@ static gchar* my_atk_text_get_text_at_offset(AtkText *text, gint offset,
 static gchar* my_atk_text_get_text_before_offset(AtkText *text, gint offset,
     AtkTextBoundary boundary_type, gint *start_offset, gint *end_offset)
 {
-    gchar *str = ((MyAtkText*)text)->str;
-    gint len = my_strlen(str);
+    TextBuffer *buffer = &((MyAtkText*)text)->buffer;
+    gint len = text_buffer_char_count(buffer);
+    TextView view;
+    text_view_init(&view, buffer);
     if((offset < 0) || (offset >= len))
     {
         return NULL;
@@ -681,15 +1123,15 @@ static gchar* my_atk_text_get_text_before_offset(AtkText *text, gint offset,
     case ATK_TEXT_BOUNDARY_WORD_START:
     case ATK_TEXT_BOUNDARY_SENTENCE_START:
     case ATK_TEXT_BOUNDARY_LINE_START:
-        if(!current_token(str, offset, end_offset, &end_tmp, tables[boundary_type]))
+        if(!text_view_current_token(&view, offset, end_offset, &end_tmp, tables[boundary_type]))
         {
-            if(!previous_token(str, offset, end_offset, &end_tmp, tables[boundary_type]))
+            if(!text_view_previous_token(&view, offset, end_offset, &end_tmp, tables[boundary_type]))
             {
                 is_successed = FALSE;
                 break;
             }
         }
-        if(!previous_token(str, *end_offset, start_offset, &end_tmp, tables[boundary_type]))
+        if(!text_view_previous_token(&view, *end_offset, start_offset, &end_tmp, tables[boundary_type]))
         {
             is_successed = FALSE;
             break;    
@@ -701,12 +1143,12 @@ static gchar* my_atk_text_get_text_before_offset(AtkText *text, gint offset,
     case ATK_TEXT_BOUNDARY_WORD_END:
     case ATK_TEXT_BOUNDARY_SENTENCE_END:
     case ATK_TEXT_BOUNDARY_LINE_END:
-        if(!previous_token(str, offset, &start_tmp, end_offset, tables[boundary_type]))
+        if(!text_view_previous_token(&view, offset, &start_tmp, end_offset, tables[boundary_type]))
         {
             is_successed = FALSE;
             break;
         }
-        if(!previous_token(str, start_tmp, &start_tmp, start_offset, tables[boundary_type]))
+        if(!text_view_previous_token(&view, start_tmp, &start_tmp, start_offset, tables[boundary_type]))
         {
             *start_offset = 0;
         }
@@ -729,34 +1171,27 @@ static gchar* my_atk_text_get_text_before_offset(AtkText *text, gint offset,
 AtkAttributeSet* my_atk_text_get_run_attributes(AtkText* text, gint offset,
     gint *start_offset, gint *end_offset)
 {
-    GList *tmp;
-    GList *attributes = ((MyAtkText*)text)->attributes;
+    GArray *attributes = ((MyAtkText*)text)->attributes;
     if(offset < 0 || offset >= my_atk_text_get_character_count(text))
     {
         TRACE0("Incorrect value of offset.");
         return NULL;
     }
-    gint start = -1, end = -1;
-    for(tmp = attributes; tmp != NULL; tmp = tmp->next)
+    guint i = range_array_search(attributes, offset);
+    if(i < attributes->len)
     {
-        Range* range = (Range*)(tmp->data); 
-        if(range->end <= offset)
-        {
-             start = range->end;
-             continue;
-        }
-        if(range->start > offset)
+        Range* range = &g_array_index(attributes, Range, i);
+        if(range->start <= offset)
         {
-             end = range->start;
-             break;
+            *start_offset = range->start;
+            *end_offset = range->end;
+            return attribute_set_copy(range->attributes->attributeSet);
         }
-        
-        *start_offset = range->start;
-        *end_offset = range->end;
-        return attribute_set_copy(range->attributeSet);
-    }    
-    *start_offset = (start == -1) ? 0 : start;
-    *end_offset = (end == -1) ? my_atk_text_get_character_count(text) : end;
+    }
+    //offset is between ranges
+    *start_offset = (i == 0) ? 0 : g_array_index(attributes, Range, i - 1).end;
+    *end_offset = (i == attributes->len) ? my_atk_text_get_character_count(text)
+        : g_array_index(attributes, Range, i).start;
     return NULL;
 }
 //*********************************my_atk_text_get_default_attributes*****************
@@ -838,7 +1273,7 @@ AtkTextRange** my_atk_text_get_bounded_ranges(AtkText *text, AtkTextRectangle *r
     
     gint start_line, end_line, start_rel_offset, end_rel_offset;
     AtkTextRange** result;    
-    gint len = my_strlen(self->str);
+    gint len = text_buffer_char_count(&self->buffer);
 //macro for simplify return empty ranges when fail to do smth
 #define RETURN_EMTPY_RANGES {result = g_malloc(sizeof(AtkTextRange*));result[0] = NULL;return result;}
     //start line
@@ -910,16 +1345,11 @@ gboolean my_atk_text_add_selection(AtkText *text, gint start_offset, gint end_of
 
     MyAtkText *self = (MyAtkText*)text;
     GArray *selections = self->selections;
-    gint i;
-    for(i = 0; i < selections->len; i++)
-    {
-        if(g_array_index(selections, TextSelection, i).start_offset >= start_offset)
-        {
-            if(g_array_index(selections, TextSelection, i).start_offset < end_offset)
-                return FALSE;
-            break;
-        }
-    }    
+    //new selection shouldn't intersect with neighbours
+    guint i = selection_search(selections, start_offset);
+    if(i < selections->len
+        && g_array_index(selections, TextSelection, i).start_offset < end_offset)
+        return FALSE;
     TextSelection new_selection;
     new_selection.start_offset = start_offset;
     new_selection.end_offset = end_offset;
@@ -990,8 +1420,8 @@ void my_atk_text_insert_text(AtkEditableText* text, const gchar* string,
 {
     gint i;
     MyAtkText* myAtkText = (MyAtkText*)text;
-    gchar *str = myAtkText->str;
-    gint strlen_old = my_strlen(str);
+    gint strlen_old = text_buffer_char_count(&myAtkText->buffer);
+    const gchar *valid_end;
     
     if(string == NULL) return;
     //correct length
@@ -999,23 +1429,16 @@ void my_atk_text_insert_text(AtkEditableText* text, const gchar* string,
     {
         if(string[i] == '\0') {length = i; break;}
     }
+    //only whole UTF-8 characters are inserted
+    g_utf8_validate(string, length, &valid_end);
+    length = valid_end - string;
     
     if(*position < 0 || *position > strlen_old || length <= 0 )return;
     
-    
-    gchar *new_str = g_malloc(strlen_old + length + 1);
-    if(new_str == NULL)return;
-    
-    if(*position != 0) 
-        memcpy(new_str, str, (size_t)*position);
-    memcpy(new_str + *position, string, (size_t)length);
-    if(strlen_old != *position) 
-        memcpy(new_str + *position + length, str + *position,
-            (size_t)(strlen_old - *position));
-    new_str[strlen_old + length] = '\0';
-    
-    g_free(str);
-    myAtkText->str = new_str;
+    text_buffer_insert(&myAtkText->buffer,
+        text_buffer_byte_offset(&myAtkText->buffer, *position), string, length);
+    //'length' is in bytes, but offsets and signals are in characters
+    length = g_utf8_strlen(string, length);
     correct_selections_after_insert(myAtkText, *position, length);
     correct_attributes_after_insert(myAtkText, *position, length);
     correct_caret_after_insert(myAtkText, *position, length);
@@ -1030,13 +1453,11 @@ void my_atk_text_insert_text(AtkEditableText* text, const gchar* string,
 void my_atk_text_delete_text(AtkEditableText* text, gint start_pos, gint end_pos)
 {
     MyAtkText* myAtkText = (MyAtkText*)text;
-    gchar *str = myAtkText->str;
-    gint strlen_old = my_strlen(str);
+    gint strlen_old = text_buffer_char_count(&myAtkText->buffer);
     
     if(start_pos < 0 || end_pos > strlen_old || start_pos >= end_pos )return;
-    if(strlen_old != end_pos)
-        memmove(str + start_pos, str + end_pos, strlen_old - end_pos);
-    str[start_pos - end_pos + strlen_old] = '\0';
+    text_buffer_delete(&myAtkText->buffer, text_buffer_byte_offset(&myAtkText->buffer, start_pos),
+        text_buffer_byte_offset(&myAtkText->buffer, end_pos));
     
     correct_selections_after_delete(myAtkText, start_pos, end_pos - start_pos);
     correct_attributes_after_delete(myAtkText, start_pos, end_pos - start_pos);
@@ -1057,17 +1478,14 @@ void my_atk_text_set_text_contents(AtkEditableText* text, const gchar* string)
 void my_atk_text_copy_text(AtkEditableText* text, gint start_pos, gint end_pos)
 {
     MyAtkText* myAtkText = (MyAtkText*)text;
-    const gchar *str = myAtkText->str;
-    gint strlen_old = my_strlen(str);
+    gint strlen_old = text_buffer_char_count(&myAtkText->buffer);
     if(start_pos < 0 || end_pos > strlen_old || start_pos >= end_pos )return;
     
     MyAtkTextClass *parent = MY_ATK_TEXT_GET_CLASS(text); 
     g_free(parent->clipboard);
-    /*parent->clipboard = g_malloc(end_pos - start_pos + 1);
-    
-    strncpy(parent->clipboard, str + start_pos, end_pos - start_pos);
-    parent->clipboard[end_pos - start_pos] = '\0';*/
-    parent->clipboard = g_strndup(str + start_pos, end_pos - start_pos); 
+    parent->clipboard = text_buffer_get_text(&myAtkText->buffer,
+        text_buffer_byte_offset(&myAtkText->buffer, start_pos),
+        text_buffer_byte_offset(&myAtkText->buffer, end_pos));
 }
 //**********************my_atk_text_paste_text***************************
 void my_atk_text_paste_text(AtkEditableText *text, gint position)
@@ -1090,48 +1508,44 @@ gboolean my_atk_text_set_run_attributes(AtkEditableText* text, AtkAttributeSet*
     gint len = atk_text_get_character_count((AtkText*)text);
     if(start_offset < 0 || start_offset >= end_offset || end_offset > len)
         return FALSE;
-    GList *attributes = self->attributes;
-    GList *tmp = attributes;
+    GArray *attributes = self->attributes;
+    guint i = range_array_search(attributes, start_offset), j;
+    Range new_range = {start_offset, end_offset,
+        attribute_set_intern(self->attribute_sets, attrib_set)};
     
-    while(tmp != NULL)
+    if(i < attributes->len)
     {
-        Range *range = (Range*)tmp->data;
+        Range *range = &g_array_index(attributes, Range, i);
         if(range->start < start_offset)
         {
-            if(range->end <= end_offset)
+            if(range->end > end_offset)
             {
-                if(range->end > start_offset) range->end = start_offset; 
-                tmp = tmp->next;
-                continue;
+                //new range splits this one into two parts
+                Range additional_range = {end_offset, range->end, range->attributes};
+                range->attributes->ref_count++;
+                range->end = start_offset;
+                g_array_insert_val(attributes, i + 1, new_range);
+                g_array_insert_val(attributes, i + 2, additional_range);
+                g_signal_emit_by_name(self, "text_attributes_changed");
+                return TRUE;
             }
-            /*range->end > end_offset*/
-            Range* additional_range = range_new(end_offset, range->end);
-            additional_range->attributeSet = attribute_set_copy(range->attributeSet);
             range->end = start_offset;
-            attributes = g_list_insert_before(attributes, tmp->next, additional_range);
-            tmp = tmp->next;
-            break;
-        }
-        else/*range->start >= start_offset*/
-        {
-            if(range->end <= end_offset)
-            {
-                GList *tmp1 = tmp->next;
-                attributes = g_list_remove_link(attributes, tmp);
-                tmp = tmp1;
-                continue;
-            }
-            /*range->end > end_offset*/
-            if(range->start < end_offset) range->start = end_offset;
-            break;
+            i++;
         }
     }
-    Range *new_range = range_new(start_offset, end_offset);
-    new_range->attributeSet = attribute_set_copy(attrib_set);
-    if(tmp == NULL)attributes = g_list_append(attributes, new_range);
-    else attributes = g_list_insert_before(attributes, tmp, new_range);
+    //ranges, covered by the new one
+    for(j = i; j < attributes->len && g_array_index(attributes, Range, j).end <= end_offset; j++);
+    if(j < attributes->len && g_array_index(attributes, Range, j).start < end_offset)
+        g_array_index(attributes, Range, j).start = end_offset;
+    if(j > i)
+    {
+        range_array_remove(self, i + 1, j - i - 1);
+        attribute_set_release(self->attribute_sets, g_array_index(attributes, Range, i).attributes);
+        g_array_index(attributes, Range, i) = new_range;
+    }
+    else
+        g_array_insert_val(attributes, i, new_range);
     
-    self->attributes = attributes;
     g_signal_emit_by_name(self, "text_attributes_changed");
     return TRUE;
 }
@@ -1147,7 +1561,9 @@ void my_atk_text_set_default_attributes(MyAtkText* text, AtkAttributeSet *set)
 
 void my_atk_text_print_run_attributes(MyAtkText *text)
 {
-    g_list_foreach(text->attributes, (GFunc)range_print, NULL);
+    guint i;
+    for(i = 0; i < text->attributes->len; i++)
+        range_print(&g_array_index(text->attributes, Range, i));
 }
 void my_atk_text_print_default_attributes(MyAtkText *text)
 {
@@ -1169,8 +1585,10 @@ static void my_atk_text_instance_init(GTypeInstance *obj, gpointer g_class)
 {
     MyAtkText *self = (MyAtkText*)obj;
     
-    self->str = NULL;
-    self->attributes = NULL;
+    text_buffer_init(&self->buffer);
+    self->attributes = g_array_new(FALSE, FALSE, sizeof(Range));
+    self->attribute_sets = g_hash_table_new_full(g_str_hash, g_str_equal,
+        NULL, (GDestroyNotify)shared_attribute_set_free);
     self->default_attributes = NULL;
     text_bounds_init(&self->bounds);
     
@@ -1181,8 +1599,10 @@ static void my_atk_text_instance_init(GTypeInstance *obj, gpointer g_class)
 static void my_atk_text_instance_finalize(GObject* obj)
 {
     MyAtkText *self = (MyAtkText*)obj;
-    g_free(self->str);
+    text_buffer_free(&self->buffer);
     my_atk_text_free_run_attributes(self);
+    g_array_free(self->attributes, TRUE);
+    g_hash_table_destroy(self->attribute_sets);
     my_atk_text_free_default_attributes(self);
     if(self->selections != NULL)g_array_free(self->selections, FALSE);
 }
@@ -32,13 +32,26 @@ typedef struct
     gint pixels_between_characters;//monoscaped font
     gint width;//width of character
 }TextBounds; 
+//Gap buffer, containing text of the object.
+//Text is stored in [0, gap_start) and [gap_end, size) parts of 'data',
+//so consecutive edits near the same position don't move the whole text.
+typedef struct
+{
+    gchar *data;
+    gint size;//allocated size of 'data'
+    gint gap_start, gap_end;
+    //cached map between character and byte offsets
+    gint char_length;//number of characters, -1 if the text was modified after map creation
+    gint *checkpoints;//byte offsets of every TEXT_BUFFER_CHECKPOINT_STEP-th character, NULL for ASCII text
+}TextBuffer;
 
 struct _MyAtkText
 {
     MyAtkObject parent;
     
-    gchar* str;//string, containing text
-    GList* attributes;//running atributes
+    TextBuffer buffer;//text
+    GArray* attributes;//running atributes, sorted array of non-intersecting ranges
+    GHashTable* attribute_sets;//interned attribute sets of ranges
     AtkAttributeSet *default_attributes;//default attributes
     
     TextBounds bounds;
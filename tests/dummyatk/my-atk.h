@@ -9,6 +9,7 @@
 #include <my-atk-hypertext.h>
 #include <my-atk-object.h>
 #include <my-atk-streamable-content.h>
+#include <my-atk-table.h>
 #include <my-atk-text.h>
 #include <my-atk-value.h>
 
@@ -1,6 +1,7 @@
 import dbus
-from gi.repository import GObject
+from gi.repository import GObject, GLib
 import os.path
+import time
 
 from xml.dom import minidom
 import os
@@ -27,6 +28,7 @@ class ComponentTest(_PasyTest):
 		     "test_contains",
 		     "test_getAccessibleAtPoint",
 		     "test_getExtents",
+		     "test_getExtentsBatch",
 		     "test_getPosition",
 		     "test_getSize",
 		     "test_getLayer",
@@ -35,6 +37,8 @@ class ComponentTest(_PasyTest):
 		     "test_registerFocusHandler",
 		     "test_deregisterFocusHandler",
 		     "test_getAlpha",
+		     "test_computeVisibleRegions",
+		     "test_spatialIndex",
 		     "teardown",
 		     ]
 
@@ -70,6 +74,17 @@ class ComponentTest(_PasyTest):
 					 % (expected[0], expected[1], expected[2], expected[3], 
 						extents[0], extents[1], extents[2], extents[3]))
 
+	def test_getExtentsBatch(self, test):
+		root = self._root
+		accessibles = [root.getChildAtIndex(0),
+			       root.getChildAtIndex(1),
+			       root,]
+
+		extents = pyatspi.getExtentsBatch(accessibles, 0)
+		expected = [value for rect in extents_expected for value in rect]
+		test.assertEqual(list(extents), expected,
+				 "Extents not correct. Expected %s, Recieved %s" % (expected, list(extents)))
+
 	def test_getPosition(self, test):
 		root = self._root
 		one = root.getChildAtIndex(0)
@@ -141,5 +156,78 @@ class ComponentTest(_PasyTest):
 	def test_getAlpha(self, test):
 		pass
 
+	def test_computeVisibleRegions(self, test):
+		root = self._root
+		regions = dict((accessible, boxes) for accessible, boxes in
+			       pyatspi.computeVisibleRegions(root, 0))
+
+		def area(accessible):
+			return sum(box.width * box.height for box in regions[accessible])
+
+		# The window layer component and the popup are above everything
+		# else, and the topmost MDI window does not meet either of them.
+		one = root.getChildAtIndex(0)
+		popup = root.getChildAtIndex(root.childCount - 1)
+		top = root.getChildAtIndex(root.childCount - 2)
+		for accessible, expected in ((one, 30 * 20), (popup, 20 * 20), (top, 30 * 30)):
+			test.assertEqual(area(accessible), expected,
+					 "Visible area not correct. Expected %d, Recieved %d"
+					 % (expected, area(accessible)))
+
+		# The topmost window's widgets are not covered by the window.
+		for i in range(top.childCount):
+			test.assertEqual(area(top.getChildAtIndex(i)), 10 * 10,
+					 "Widget %d of the top window is covered" % i)
+
+	def test_spatialIndex(self, test):
+		root = self._root
+		index = pyatspi.SpatialIndex(root, 0)
+		size = len(index)
+		test.assertEqual(size, 1 + root.childCount + 4 * 9,
+				 "Spatial index holds %d components" % size)
+
+		# The deepest component wins: a widget of the first MDI window,
+		# then the second component where no window reaches.
+		widget = root.getChildAtIndex(2).getChildAtIndex(0)
+		for point, expected in (((5, 5), widget),
+					((65, 65), root.getChildAtIndex(1))):
+			found = index.getAccessibleAtPoint(*point)
+			test.assertEqual(found, expected,
+					 "Wrong accessible at (%d, %d)" % point)
+
+		# Each stage of the application changes the first widget; the
+		# index follows it through the events once started.
+		index.start()
+		try:
+			self._nextStage()
+			moved = self._waitFor(index, (65, 65), widget)
+			test.assertEqual(moved, widget, "Bounds change of a widget not followed")
+			test.assertNotEqual(index.getAccessibleAtPoint(5, 5), widget,
+					    "Widget still found at its previous position")
+
+			self._nextStage()
+			hidden = self._waitFor(index, (65, 65), root.getChildAtIndex(1))
+			test.assertEqual(hidden, root.getChildAtIndex(1),
+					 "Widget that stopped showing still indexed")
+			test.assertEqual(len(index), size - 1,
+					 "Spatial index holds %d components after a widget was hidden"
+					 % len(index))
+		finally:
+			index.stop()
+
+	def _nextStage(self):
+		to = self._bus.get_object(self._path, "/org/codethink/atspi/test")
+		dbus.Interface(to, "org.codethink.atspi.test").next()
+
+	def _waitFor(self, index, point, expected):
+		# The events of a stage arrive through the main loop.
+		context = GLib.MainContext.default()
+		deadline = time.time() + 5
+		found = index.getAccessibleAtPoint(*point)
+		while found != expected and time.time() < deadline:
+			context.iteration(False)
+			found = index.getAccessibleAtPoint(*point)
+		return found
+
 	def teardown(self, test):
 		pass
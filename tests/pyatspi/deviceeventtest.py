@@ -0,0 +1,103 @@
+import pickle
+
+from pasytest import PasyTest as _PasyTest
+
+import pyatspi
+from pyatspi.deviceevent import DeviceEvent, EventListenerMode, KeyDefinition
+
+# The device event records are plain Python objects; the tests do not need
+# the test application.
+
+fields = [pyatspi.KEY_PRESSED_EVENT, 97, 38, 4, 1000, "a", True]
+
+class DeviceEventTest(_PasyTest):
+
+	__tests__ = ["setup",
+		     "test_attributes",
+		     "test_sequence",
+		     "test_listMethods",
+		     "test_compare",
+		     "test_pickle",
+		     "teardown",
+		     ]
+
+	def __init__(self, bus, path):
+		_PasyTest.__init__(self, "DeviceEvent", False)
+
+	def setup(self, test):
+		pass
+
+	def test_attributes(self, test):
+		event = DeviceEvent(*fields)
+		test.assertEqual([event.type, event.id, event.hw_code, event.modifiers,
+				  event.timestamp, event.event_string, event.is_text], fields,
+				 "Attributes do not hold the fields")
+		test.assertEqual(event.consume, False, "consume not initially False")
+		event.hw_code = 40
+		test.assertEqual(event[2], 40, "Attribute not seen by index")
+		event[2] = 41
+		test.assertEqual(event.hw_code, 41, "Index not seen by attribute")
+		mode = EventListenerMode(True, False, True)
+		test.assertEqual((mode.synchronous, mode.preemptive, mode.global_), (True, False, True),
+				 "EventListenerMode attributes not correct")
+		key = KeyDefinition(38, 97, "a", 0)
+		test.assertEqual((key.keycode, key.keysym, key.keystring, key.unused), (38, 97, "a", 0),
+				 "KeyDefinition attributes not correct")
+
+	def test_sequence(self, test):
+		event = DeviceEvent(*fields)
+		test.assertEqual(len(event), len(fields), "Wrong length")
+		test.assertEqual(event[-1], True, "Negative index not supported")
+		test.assertEqual(event[1:3], [97, 38], "Slice not correct")
+		type, id, hw_code, modifiers, timestamp, event_string, is_text = event
+		test.assertEqual(hw_code, 38, "Unpacking not correct")
+		test.assertEqual(list(event), fields, "Iteration not correct")
+		if "a" not in event:
+			test.fail("Membership not supported")
+		test.assertEqual(repr(event), repr(fields), "repr not the list repr")
+		if isinstance(event, list):
+			test.fail("Records are not expected to be lists")
+		try:
+			event[len(fields)]
+			test.fail("Index past the fields accepted")
+		except IndexError:
+			pass
+
+	def test_listMethods(self, test):
+		event = DeviceEvent(*fields)
+		test.assertEqual(event.index(38), 2, "index not correct")
+		test.assertEqual(event.count(True), fields.count(True), "count not correct")
+		test.assertEqual(event + [1], fields + [1], "Concatenation not correct")
+		test.assertEqual([1] + event, [1] + fields, "Reflected concatenation not correct")
+		test.assertEqual(event + DeviceEvent(*fields), fields + fields,
+				 "Concatenation of records not correct")
+
+	def test_compare(self, test):
+		event = DeviceEvent(*fields)
+		if not (event == fields and event == tuple(fields) and fields == event):
+			test.fail("Record not equal to a list of its fields")
+		if event != DeviceEvent(*fields):
+			test.fail("Records with the same fields not equal")
+		other = DeviceEvent(*fields)
+		other.hw_code = 0
+		if event == other:
+			test.fail("Records with different fields equal")
+		try:
+			hash(event)
+			test.fail("Records are hashable, unlike lists")
+		except TypeError:
+			pass
+
+	def test_pickle(self, test):
+		event = DeviceEvent(*fields)
+		event.consume = True
+		for protocol in range(pickle.HIGHEST_PROTOCOL + 1):
+			copy = pickle.loads(pickle.dumps(event, protocol))
+			test.assertEqual(type(copy), DeviceEvent, "Wrong type after pickling")
+			test.assertEqual(copy, event, "Fields lost by pickling, protocol %d" % protocol)
+			test.assertEqual(copy.consume, True, "consume lost by pickling, protocol %d" % protocol)
+		key = KeyDefinition(38, 97, "a", 0)
+		test.assertEqual(pickle.loads(pickle.dumps(key)), key, "KeyDefinition not pickled")
+
+	def teardown(self, test):
+		pass
@@ -0,0 +1,151 @@
+import os
+import tempfile
+
+from pasytest import PasyTest as _PasyTest
+
+from pyatspi.eventtrace import EventTraceWriter, EventTraceReader
+
+from stubs import Event
+
+# The event trace tests write stub events to a trace file and query it;
+# they do not need the test application.
+
+class Application(object):
+	def __init__(self, bus_name):
+		self.bus_name = bus_name
+
+class Source(object):
+	def __init__(self, bus_name, path):
+		self.app = Application(bus_name)
+		self.path = path
+
+	def getRole(self):
+		return 0
+
+types = ["object:state-changed:focused",
+	 "object:state-changed:showing",
+	 "object:children-changed:add",
+	 "object:text-changed:insert",]
+sources = [Source(":1.%d" % (i % 3), "/org/a11y/atspi/accessible/%d" % i) for i in range(10)]
+
+# 250 events, one every 0.1 second, written in chunks of 32 events.
+CHUNK_SIZE = 32
+events = []
+for i in range(250):
+	any_data = (None, "text %d" % i, sources[0], i)[i % 4]
+	events.append((100.0 + i * 0.1,
+		       Event(types[i % len(types)], sources[(i * 7) % len(sources)], i, -i, any_data)))
+
+def path(source):
+	return source.app.bus_name + source.path
+
+def summary(value):
+	if value is None:
+		return ""
+	if isinstance(value, Source):
+		return path(value)
+	return str(value)
+
+def expected(match, start=None, end=None):
+	return [(timestamp, event.type, path(event.source), event.detail1, event.detail2,
+		 summary(event.any_data))
+		for timestamp, event in events
+		if match(event) and (start is None or timestamp >= start) and
+		   (end is None or timestamp <= end)]
+
+def read(results):
+	return [(event.time, event.type, event.source, event.detail1, event.detail2,
+		 event.any_data)
+		for event in results]
+
+class EventTraceTest(_PasyTest):
+
+	__tests__ = ["setup",
+		     "test_all",
+		     "test_typePrefix",
+		     "test_source",
+		     "test_timeRange",
+		     "test_truncated",
+		     "test_unknownSource",
+		     "teardown",
+		     ]
+
+	def __init__(self, bus, path):
+		_PasyTest.__init__(self, "EventTrace", False)
+
+	def setup(self, test):
+		handle, self.filename = tempfile.mkstemp(".trace")
+		os.close(handle)
+		writer = EventTraceWriter(self.filename, CHUNK_SIZE)
+		for timestamp, event in events:
+			writer.record(event, timestamp)
+		writer.close()
+		self.reader = EventTraceReader(self.filename)
+
+	def test_all(self, test):
+		test.assertEqual(len(self.reader), len(events), "Wrong number of events")
+		test.assertEqual(read(self.reader.query()), expected(lambda event: True),
+				 "Events read back differ from the events written")
+
+	def test_typePrefix(self, test):
+		results = read(self.reader.query(types="object:state-changed"))
+		test.assertEqual(results,
+				 expected(lambda event: event.type.startswith("object:state-changed:")),
+				 "Partial event type not matched")
+		results = read(self.reader.query(types=["object:children-changed:add",
+							"object:text-changed"]))
+		test.assertEqual(results,
+				 expected(lambda event: event.type in types[2:]),
+				 "Full and partial event types not matched")
+		test.assertEqual(self.reader.query(types="object:state"), [],
+				 "Partial event type matched within a name")
+
+	def test_source(self, test):
+		wanted = [path(sources[3]), path(sources[4])]
+		results = read(self.reader.query(sources=wanted))
+		test.assertEqual(results, expected(lambda event: path(event.source) in wanted),
+				 "Events not matched by source")
+
+	def test_timeRange(self, test):
+		# The range starts and ends within chunks and spans whole chunks.
+		start, end = 103.05, 114.95
+		results = read(self.reader.query(start=start, end=end))
+		test.assertEqual(results, expected(lambda event: True, start, end),
+				 "Events not matched by time")
+		results = read(self.reader.query(types="object:state-changed:focused",
+						 sources=[path(sources[0])], start=start, end=end))
+		test.assertEqual(results,
+				 expected(lambda event: event.type == types[0] and
+					  event.source is sources[0], start, end),
+				 "Events not matched by type, source and time")
+		test.assertEqual(self.reader.query(start=200.0), [], "Events found after the trace")
+
+	def test_truncated(self, test):
+		# Cut the trace in the middle of its last chunk.
+		size = os.path.getsize(self.filename)
+		handle = open(self.filename, "r+b")
+		handle.truncate(size - 50)
+		handle.close()
+		reader = EventTraceReader(self.filename)
+		count = len(events) - len(events) % CHUNK_SIZE
+		test.assertEqual(len(reader), count, "Truncated chunk not dropped")
+		test.assertEqual(read(reader.query()), expected(lambda event: True)[:count],
+				 "Events before the truncated chunk not read")
+		reader.close()
+
+	def test_unknownSource(self, test):
+		handle, filename = tempfile.mkstemp(".trace")
+		os.close(handle)
+		writer = EventTraceWriter(filename)
+		writer.record(Event(types[0], object(), 1, 0, object()), 100.0)
+		writer.close()
+		reader = EventTraceReader(filename)
+		results = read(reader.query())
+		reader.close()
+		os.remove(filename)
+		test.assertEqual(results, [(100.0, types[0], "unknown", 1, 0, "object")],
+				 "Source without a bus name and path not recorded as unknown")
+
+	def teardown(self, test):
+		self.reader.close()
+		os.remove(self.filename)
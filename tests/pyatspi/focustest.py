@@ -0,0 +1,123 @@
+from pasytest import PasyTest as _PasyTest
+
+import pyatspi
+
+from stubs import Event
+
+# Focus changes are given to the tracker directly, or as stub events, so
+# that no application has to move its focus.
+
+def _ancestors(accessible):
+	ancestors = []
+	parent = accessible.parent
+	while parent is not None:
+		ancestors.append(parent)
+		parent = parent.parent
+	return ancestors
+
+def _names(accessibles):
+	return [accessible.name for accessible in accessibles]
+
+class FocusTest(_PasyTest):
+
+	__tests__ = ["setup",
+		     "test_siblings",
+		     "test_nested",
+		     "test_events",
+		     "teardown",
+		     ]
+
+	def __init__(self, bus, path):
+		_PasyTest.__init__(self, "Focus", False)
+		self._bus = bus
+		self._path = path
+
+	def setup(self, test):
+		self._registry = pyatspi.Registry()
+		self._desktop = self._registry.getDesktop(0)
+		self._root = pyatspi.findDescendant (self._desktop, lambda x: x.name == "atspi-test-main" and x.getRole() == pyatspi.ROLE_WINDOW)
+		self._panel = self._root.getChildAtIndex(1)
+		self._firefox = pyatspi.findDescendant(self._root, lambda x: x.name == "Firefox")
+		self._back = pyatspi.findDescendant(self._firefox, lambda x: x.name == "Back")
+		self._forward = pyatspi.findDescendant(self._firefox, lambda x: x.name == "Forward")
+
+	def _checkAncestors(self, test, tracker, accessible):
+		expected = _ancestors(accessible)
+		ancestors = tracker.getAncestors()
+		test.assertEqual(ancestors, expected,
+				 "Ancestors of %s expected %s, recieved %s"
+				 % (accessible.name, _names(expected), _names(ancestors)))
+
+	def test_siblings(self, test):
+		tracker = pyatspi.FocusTracker()
+		bottom = self._panel.getChildAtIndex(0)
+		top = self._panel.getChildAtIndex(1)
+		tracker.setFocus(bottom)
+		self._checkAncestors(test, tracker, bottom)
+		test.assertEqual(tracker.isInside(bottom), True, "Focus not inside itself")
+		test.assertEqual(tracker.isInside(self._panel), True, "Focus not inside its parent")
+		test.assertEqual(tracker.isInside(self._root), True, "Focus not inside the root")
+		test.assertEqual(tracker.isInside(self._firefox), False, "Focus inside an unrelated object")
+
+		tracker.setFocus(top)
+		test.assertEqual(tracker.getFocus(), top, "Focus not moved to the sibling")
+		self._checkAncestors(test, tracker, top)
+		test.assertEqual(tracker.isInside(bottom), False, "Focus still inside the previous sibling")
+		test.assertEqual(tracker.isInside(self._panel), True, "Focus not inside the common parent")
+		test.assertEqual(tracker.getPreviousFocus(), bottom, "Wrong previous focus")
+
+	def test_nested(self, test):
+		tracker = pyatspi.FocusTracker()
+		window = self._firefox.getChildAtIndex(0)
+		toolbar = self._back.parent
+		tracker.setFocus(window)
+		self._checkAncestors(test, tracker, window)
+
+		# Down into a descendant of the focus, then across siblings
+		tracker.setFocus(self._back)
+		self._checkAncestors(test, tracker, self._back)
+		test.assertEqual(tracker.isInside(window), True, "Focus not inside the previous focus")
+		test.assertEqual(tracker.isInside(toolbar), True, "Focus not inside its parent")
+		tracker.setFocus(self._forward)
+		self._checkAncestors(test, tracker, self._forward)
+		test.assertEqual(tracker.isInside(self._back), False, "Focus still inside a sibling")
+		test.assertEqual(tracker.findAncestor(lambda x: x.name == "Firefox"), self._firefox,
+				 "Ancestor not found")
+		test.assertEqual(tracker.findAncestor(lambda x: x.name == "nautilus"), None,
+				 "Unrelated ancestor found")
+
+		# Up to an ancestor, then over to another branch
+		tracker.setFocus(self._firefox)
+		self._checkAncestors(test, tracker, self._firefox)
+		test.assertEqual(tracker.isInside(window), False, "Focus still inside a descendant")
+		tracker.setFocus(self._panel)
+		self._checkAncestors(test, tracker, self._panel)
+		test.assertEqual(tracker.isInside(self._firefox), False, "Focus still inside another branch")
+		test.assertEqual(tracker.getPreviousFocus(), self._firefox, "Wrong previous focus")
+		test.assertEqual([accessible for timestamp, accessible in tracker.getHistory()],
+				 [window, self._back, self._forward, self._firefox, self._panel],
+				 "Wrong focus history")
+
+	def test_events(self, test):
+		tracker = pyatspi.FocusTracker()
+		tracker.handleEvent(Event("object:state-changed:focused", self._back, 1))
+		test.assertEqual(tracker.getFocus(), self._back, "Focus not set by an event")
+		self._checkAncestors(test, tracker, self._back)
+
+		# A parent change of an object in the chain fetches the ancestors again
+		tracker.handleEvent(Event("object:property-change:accessible-parent", self._back.parent))
+		test.assertEqual(tracker.getFocus(), self._back, "Focus lost on a parent change")
+		self._checkAncestors(test, tracker, self._back)
+		tracker.handleEvent(Event("object:property-change:accessible-parent", self._panel))
+		self._checkAncestors(test, tracker, self._back)
+
+		# Losing the focus on another object keeps the current one
+		tracker.handleEvent(Event("object:state-changed:focused", self._forward, 0))
+		test.assertEqual(tracker.getFocus(), self._back, "Focus lost by another object")
+		tracker.handleEvent(Event("object:state-changed:focused", self._back, 0))
+		test.assertEqual(tracker.getFocus(), None, "Focus not cleared")
+		test.assertEqual(tracker.getAncestors(), [], "Ancestors kept without a focus")
+		test.assertEqual(tracker.isInside(self._root), False, "Inside an object without a focus")
+
+	def teardown(self, test):
+		pass
@@ -0,0 +1,50 @@
+#!/usr/bin/env python
+#
+# Measures how long "import pyatspi" takes on top of loading the Atspi
+# typelib, which pyatspi cannot avoid. Each import runs in a fresh
+# interpreter; the median of several runs is reported.
+#
+# Exits with a failure status when the overhead exceeds the budget, in
+# milliseconds, given with --budget or PYATSPI_IMPORT_BUDGET_MS.
+
+import os
+import subprocess
+import sys
+import time
+
+from optparse import OptionParser
+
+BASELINE = "import gi; gi.require_version('Atspi', '2.0'); from gi.repository import Atspi"
+PYATSPI = BASELINE + "; import pyatspi"
+
+def median_import_time(statement, runs):
+	times = []
+	for i in range(runs):
+		start = time.time()
+		subprocess.check_call([sys.executable, "-c", statement])
+		times.append(time.time() - start)
+	times.sort()
+	return times[len(times) // 2]
+
+def main(argv):
+	parser = OptionParser()
+	parser.add_option("-n", "--runs", dest="runs", type="int", default=15)
+	parser.add_option("-b", "--budget", dest="budget", type="float",
+			  default=float(os.environ.get("PYATSPI_IMPORT_BUDGET_MS", 100)))
+	(options, args) = parser.parse_args(argv)
+
+	baseline = median_import_time(BASELINE, options.runs) * 1000
+	total = median_import_time(PYATSPI, options.runs) * 1000
+	overhead = total - baseline
+
+	print("Atspi typelib: %.1f ms" % baseline)
+	print("import pyatspi: %.1f ms" % total)
+	print("pyatspi overhead: %.1f ms (budget %.1f ms)" % (overhead, options.budget))
+
+	if overhead > options.budget:
+		print("Import overhead over budget")
+		return 1
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,66 @@
+import subprocess
+import sys
+
+from pasytest import PasyTest as _PasyTest
+
+# Each check runs in a fresh interpreter, so that no module has been
+# imported by an earlier test.
+
+SUBMODULES = """
+import sys
+import pyatspi
+lazy = sys.version_info >= (3, 7)
+if lazy and "pyatspi.text" in sys.modules:
+	raise SystemExit("pyatspi.text imported by import pyatspi")
+pyatspi.text.Text
+pyatspi.table.TableGridCell
+pyatspi.utils.findDescendant
+pyatspi.registry.Registry
+if pyatspi.text is not sys.modules["pyatspi.text"]:
+	raise SystemExit("pyatspi.text is not the text module")
+try:
+	pyatspi.nosuchmodule
+	raise SystemExit("Missing submodule resolved")
+except AttributeError:
+	pass
+"""
+
+LAZY_NAMES = """
+import pyatspi
+pyatspi.Text
+pyatspi.TEXT_BOUNDARY_WORD_START
+pyatspi.FocusTracker
+"""
+
+def run(statement):
+	process = subprocess.Popen([sys.executable, "-c", statement],
+				   stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+	output = process.communicate()[0]
+	return process.returncode, output
+
+class ImportTest(_PasyTest):
+
+	__tests__ = ["setup",
+		     "test_submodules",
+		     "test_lazyNames",
+		     "teardown",
+		     ]
+
+	def __init__(self, bus, path):
+		_PasyTest.__init__(self, "Import", False)
+
+	def setup(self, test):
+		pass
+
+	def test_submodules(self, test):
+		status, output = run(SUBMODULES)
+		if status != 0:
+			test.fail("Submodule attribute access failed: %s" % (output,))
+
+	def test_lazyNames(self, test):
+		status, output = run(LAZY_NAMES)
+		if status != 0:
+			test.fail("Lazy name access failed: %s" % (output,))
+
+	def teardown(self, test):
+		pass
@@ -0,0 +1,112 @@
+import time
+
+from gi.repository import GLib
+
+from pasytest import PasyTest as _PasyTest
+
+import pyatspi
+import pyatspi.registry
+
+# Synthesized events are recorded by a stand-in for generate_keyboard_event
+# instead of being sent to the registry daemon.
+
+class KeyboardRecorder(object):
+	def __init__(self, failAt=None):
+		self.calls = []
+		self.failAt = failAt
+
+	def __call__(self, keycode, keysym, kind):
+		if len(self.calls) == self.failAt:
+			raise RuntimeError("synthesis failed")
+		self.calls.append((time.time(), keycode, keysym, int(kind)))
+
+class InputTest(_PasyTest):
+
+	__tests__ = ["setup",
+		     "test_stringChunks",
+		     "test_failureSynchronous",
+		     "test_failureMainLoop",
+		     "teardown",
+		     ]
+
+	def __init__(self, bus, path):
+		_PasyTest.__init__(self, "Input", False)
+
+	def setup(self, test):
+		self._registry = pyatspi.Registry()
+		self._generate = pyatspi.registry.Atspi.generate_keyboard_event
+
+	def _patch(self, recorder):
+		pyatspi.registry.Atspi.generate_keyboard_event = recorder
+
+	def test_stringChunks(self, test):
+		recorder = KeyboardRecorder()
+		self._patch(recorder)
+		finished = []
+		actions = [('string', "ab"),
+			   ('key', 0, "cd", pyatspi.KEY_STRING),
+			   ('delay', 50),
+			   ('string', "x" * 150),
+			   ('key', 38, None, pyatspi.KEY_PRESS),
+			   ('delay', 20),
+			   ('delay', 30),
+			   ('string', "y"),]
+		start = time.time()
+		sequence = self._registry.generateInputSequence(actions, lambda: finished.append(True),
+								synchronous=True, chunkSize=64)
+		calls = [call[1:] for call in recorder.calls]
+		string = int(pyatspi.KEY_STRING)
+		test.assertEqual(calls, [(0, "abcd", string),
+					 (0, "x" * 64, string),
+					 (0, "x" * 64, string),
+					 (0, "x" * 22, string),
+					 (38, "", int(pyatspi.KEY_PRESS)),
+					 (0, "y", string)],
+				 "Strings not merged and chunked as expected: %s" % (calls,))
+		times = [call[0] - start for call in recorder.calls]
+		if times[0] > 0.04 or times[1] < 0.05 or times[1] - times[0] < 0.05:
+			test.fail("Delay before the second string not respected: %s" % (times,))
+		if times[3] - times[1] > 0.04:
+			test.fail("Chunks of one string were delayed: %s" % (times,))
+		if times[5] - times[4] < 0.05:
+			test.fail("Consecutive delays not added up: %s" % (times,))
+		test.assertEqual(finished, [True], "Callback not called once")
+		test.assertEqual(sequence.done, True, "Sequence not done")
+
+	def test_failureSynchronous(self, test):
+		recorder = KeyboardRecorder(failAt=1)
+		self._patch(recorder)
+		finished = []
+		actions = [('key', 38, None, pyatspi.KEY_PRESS),
+			   ('key', 39, None, pyatspi.KEY_PRESS),
+			   ('key', 40, None, pyatspi.KEY_PRESS),]
+		try:
+			self._registry.generateInputSequence(actions, lambda: finished.append(True),
+							     synchronous=True)
+			test.fail("Error of a failed action not raised")
+		except RuntimeError:
+			pass
+		test.assertEqual(len(recorder.calls), 1, "Actions played after a failure")
+		test.assertEqual(finished, [True], "Callback not called after a failure")
+
+	def test_failureMainLoop(self, test):
+		recorder = KeyboardRecorder(failAt=1)
+		self._patch(recorder)
+		finished = []
+		actions = [('key', 38, None, pyatspi.KEY_PRESS),
+			   ('delay', 10),
+			   ('key', 39, None, pyatspi.KEY_PRESS),
+			   ('key', 40, None, pyatspi.KEY_PRESS),]
+		sequence = self._registry.generateInputSequence(actions, lambda: finished.append(True))
+		context = GLib.MainContext.default()
+		deadline = time.time() + 5
+		while not sequence.done and time.time() < deadline:
+			context.iteration(False)
+		test.assertEqual(sequence.done, True, "Sequence not done after a failure")
+		if not isinstance(sequence.error, RuntimeError):
+			test.fail("Error of the failed action not kept: %r" % (sequence.error,))
+		test.assertEqual(len(recorder.calls), 1, "Actions played after a failure")
+		test.assertEqual(finished, [True], "Callback not called after a failure")
+
+	def teardown(self, test):
+		self._patch(self._generate)
@@ -0,0 +1,87 @@
+#!/usr/bin/env python
+#
+# Measures how long a KeyBindings table takes to decide whether to consume
+# a key event, which is what the registry daemon waits for, with handlers
+# deferred to the main loop and with the same handlers run inline. Events
+# are synthesized; no registry daemon is needed.
+
+import random
+import sys
+import time
+
+from optparse import OptionParser
+
+from gi.repository import GLib
+
+from pyatspi.registry import KeyBindings, _KeyBindingsDispatcher
+
+class FakeEvent(object):
+	def __init__(self, keysym, hw_code, modifiers):
+		self.type = 0
+		self.id = keysym
+		self.hw_code = hw_code
+		self.modifiers = modifiers
+		self.timestamp = 0
+		self.event_string = ""
+		self.is_text = False
+
+def percentile(times, fraction):
+	return times[min(len(times) - 1, int(len(times) * fraction))]
+
+def measure(dispatcher, events):
+	times = []
+	for event in events:
+		start = time.time()
+		dispatcher(event)
+		times.append(time.time() - start)
+	times.sort()
+	return times
+
+def report(name, times):
+	print("%-10s median %8.1f us  p99 %8.1f us  worst %8.1f us" %
+	      (name, percentile(times, 0.5) * 1e6, percentile(times, 0.99) * 1e6, times[-1] * 1e6))
+
+def main(argv):
+	parser = OptionParser()
+	parser.add_option("-b", "--bindings", dest="bindings", type="int", default=500)
+	parser.add_option("-e", "--events", dest="events", type="int", default=2000)
+	parser.add_option("-w", "--work", dest="work", type="float", default=1.0,
+			  help="milliseconds spent by each handler")
+	(options, args) = parser.parse_args(argv)
+
+	def handler(event):
+		end = time.time() + options.work / 1000.0
+		while time.time() < end:
+			pass
+
+	bindings = KeyBindings()
+	keys = []
+	for i in range(options.bindings):
+		keysym = 0x20 + i
+		modifiers = random.choice((0, 1, 4, 5, 8))
+		bindings.add(handler, keysym=keysym, modifiers=modifiers)
+		keys.append((keysym, modifiers))
+	events = []
+	for i in range(options.events):
+		if random.random() < 0.5:
+			keysym, modifiers = random.choice(keys)
+		else:
+			keysym, modifiers = 0x10000 + i, 0
+		events.append(FakeEvent(keysym, 0, modifiers))
+
+	deferred = _KeyBindingsDispatcher(bindings, True, False)
+	inline = _KeyBindingsDispatcher(bindings, False, False)
+
+	print("%d bindings, %d events, %.1f ms handlers" %
+	      (options.bindings, options.events, options.work))
+	report("deferred", measure(deferred, events))
+	report("inline", measure(inline, events[:options.events // 10]))
+
+	# run the deferred handlers
+	context = GLib.MainContext.default()
+	while context.pending():
+		context.iteration(False)
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,157 @@
+from pasytest import PasyTest as _PasyTest
+
+import pyatspi
+import pyatspi.registry
+from pyatspi.deviceevent import DeviceEvent, KEY_PRESSED_EVENT
+from pyatspi.registry import KeyBindings
+
+from stubs import NativeRecorder
+
+# Key events are given to the keystroke filter of the registered bindings,
+# as the registry daemon would; handlers deferred to the main loop are
+# queued by a stand-in for GLib.idle_add.
+
+SHIFT = 1
+CONTROL = 4
+
+def keyEvent(keysym, keycode, modifiers=0):
+	return DeviceEvent(KEY_PRESSED_EVENT, keysym, keycode, modifiers, 0, "", True)
+
+class IdleQueue(object):
+	def __init__(self):
+		self.calls = []
+
+	def __call__(self, function, *args):
+		self.calls.append((function, args))
+		return len(self.calls)
+
+	def run(self):
+		calls = self.calls
+		self.calls = []
+		for function, args in calls:
+			function(*args)
+
+class KeyBindingsTest(_PasyTest):
+
+	__tests__ = ["setup",
+		     "test_lookup",
+		     "test_decisions",
+		     "test_deferred",
+		     "test_masks",
+		     "teardown",
+		     ]
+
+	def __init__(self, bus, path):
+		_PasyTest.__init__(self, "KeyBindings", False)
+
+	def setup(self, test):
+		self._registry = pyatspi.Registry()
+		self._recorder = NativeRecorder()
+		self._recorder.install()
+		self._idle = IdleQueue()
+		self._idleAdd = pyatspi.registry.GLib.idle_add
+		pyatspi.registry.GLib.idle_add = self._idle
+		self._handled = []
+
+	def _handler(self, name):
+		def handler(event):
+			self._handled.append((name, event.id, event.hw_code, event.modifiers))
+		return handler
+
+	def _register(self, bindings, deferred=False):
+		self._registry.registerKeyBindings(bindings, deferred=deferred)
+		dispatcher = self._registry.key_bindings[bindings]
+		listener, keyFilter = self._registry.keystroke_listeners[dispatcher]
+		return keyFilter
+
+	def test_lookup(self, test):
+		bindings = KeyBindings()
+		byKeycode = self._handler("keycode")
+		byKeysym = self._handler("keysym")
+		withControl = self._handler("control")
+		bindings.add(byKeycode, keycode=38)
+		bindings.add(byKeysym, keysym=0x61)
+		bindings.add(withControl, keysym=0x61, modifiers=CONTROL)
+		test.assertEqual(bindings.lookup(keyEvent(0x61, 38)), (True, byKeysym),
+				 "Keysym binding does not win over the key code binding")
+		test.assertEqual(bindings.lookup(keyEvent(0x71, 38)), (True, byKeycode),
+				 "Key code binding not used without a keysym binding")
+		test.assertEqual(bindings.lookup(keyEvent(0x61, 38, CONTROL | 0x100)), (True, withControl),
+				 "Modifiers above the low eight bits not ignored")
+		test.assertEqual(bindings.lookup(keyEvent(0x61, 38, CONTROL | SHIFT)), None,
+				 "Binding found for modifiers that do not match exactly")
+		test.assertEqual(bindings.masks(), [0, CONTROL], "Wrong masks")
+
+	def test_decisions(self, test):
+		bindings = KeyBindings()
+		bindings.add(self._handler("consumed"), keysym=0x61)
+		bindings.add(self._handler("passed"), keysym=0x62, consume=False)
+		bindings.add(self._handler("control"), keysym=0x61, modifiers=CONTROL)
+		bindings.add(None, keycode=9)
+		keyFilter = self._register(bindings)
+		self._recorder.take()
+		for event, consume, handled in ((keyEvent(0x61, 38), True, "consumed"),
+						(keyEvent(0x62, 56), False, "passed"),
+						(keyEvent(0x61, 38, CONTROL), True, "control"),
+						# modifiers must match exactly
+						(keyEvent(0x61, 38, CONTROL | SHIFT), False, None),
+						(keyEvent(0xff1b, 9), True, None),
+						(keyEvent(0x63, 54), False, None)):
+			self._handled = []
+			result = keyFilter(event)
+			test.assertEqual(bool(result), consume,
+					 "Event %x with modifiers %d: consume expected %s, recieved %s"
+					 % (event.id, event.modifiers, consume, result))
+			names = [name for name, keysym, keycode, modifiers in self._handled]
+			test.assertEqual(names, [handled] if handled else [],
+					 "Event %x with modifiers %d: wrong handlers %s"
+					 % (event.id, event.modifiers, names))
+		test.assertEqual(self._idle.calls, [], "Handlers deferred with deferred=False")
+		self._registry.deregisterKeyBindings(bindings)
+		self._recorder.take()
+
+	def test_deferred(self, test):
+		bindings = KeyBindings()
+		bindings.add(self._handler("deferred"), keysym=0x61)
+		keyFilter = self._register(bindings, deferred=True)
+		self._handled = []
+		test.assertEqual(keyFilter(keyEvent(0x61, 38, 0)), True, "Event not consumed")
+		test.assertEqual(self._handled, [], "Handler run before the decision was returned")
+		test.assertEqual(len(self._idle.calls), 1, "Handler not queued for the main loop")
+		self._idle.run()
+		test.assertEqual(self._handled, [("deferred", 0x61, 38, 0)],
+				 "Deferred handler not run with a copy of the event")
+		self._registry.deregisterKeyBindings(bindings)
+		self._recorder.take()
+
+	def test_masks(self, test):
+		registry = self._registry
+		bindings = KeyBindings()
+		bindings.add(None, keysym=0x61)
+		bindings.add(None, keysym=0x61, modifiers=CONTROL)
+		registry.registerKeyBindings(bindings)
+		calls = self._recorder.take()
+		test.assertEqual(sorted(call[1] for call in calls if call[0] == "register"), [0, CONTROL],
+				 "Masks of the bindings not registered: %s" % (calls,))
+
+		bindings.remove(keysym=0x61, modifiers=CONTROL)
+		registry.registerKeyBindings(bindings)
+		calls = self._recorder.take()
+		test.assertEqual([call[:2] for call in calls], [("deregister", CONTROL)],
+				 "Mask of a removed binding not deregistered: %s" % (calls,))
+
+		bindings.remove(keysym=0x61)
+		registry.registerKeyBindings(bindings)
+		calls = self._recorder.take()
+		test.assertEqual([call[:2] for call in calls], [("deregister", 0)],
+				 "Mask of the last binding not deregistered: %s" % (calls,))
+		dispatcher = registry.key_bindings[bindings]
+		test.assertEqual(dispatcher in registry.keystroke_listeners, False,
+				 "Keystroke listener kept without bindings")
+
+		registry.deregisterKeyBindings(bindings)
+		test.assertEqual(self._recorder.take(), [], "Native calls for an empty table")
+
+	def teardown(self, test):
+		pyatspi.registry.GLib.idle_add = self._idleAdd
+		self._recorder.uninstall()
@@ -0,0 +1,96 @@
+import os
+import tempfile
+
+from pasytest import PasyTest as _PasyTest
+
+import pyatspi
+from pyatspi.deviceevent import DeviceEvent, KEY_PRESSED_EVENT, KEY_RELEASED_EVENT
+from pyatspi.keylog import KeyRecorder, KeyLogReader, replayKeyLog
+from pyatspi.registry import _KeystrokeFilter
+
+# The key log tests only use the log file and the keystroke filters; they
+# do not need the test application.
+
+events = [DeviceEvent(KEY_PRESSED_EVENT, 0x61, 38, 0, 1000, "a", True),
+	  DeviceEvent(KEY_RELEASED_EVENT, 0x61, 38, 0, 1010, "a", True),
+	  DeviceEvent(KEY_PRESSED_EVENT, 0xe9, 47, 1, 1020, u"\xe9", True),
+	  DeviceEvent(KEY_RELEASED_EVENT, 0xe9, 47, 1, 1030, u"\xe9", True),
+	  DeviceEvent(KEY_PRESSED_EVENT, 0xff0d, 36, 4, 0xfffffff0, "Return", False),
+	  DeviceEvent(KEY_RELEASED_EVENT, 0xff0d, 36, 4, 5, "Return", False),]
+
+def fields(event):
+	string = event.event_string
+	if isinstance(string, bytes):
+		string = string.decode("utf-8")
+	return (int(event.type), event.id, event.hw_code, event.modifiers,
+		event.timestamp, string, bool(event.is_text))
+
+class KeyLogTest(_PasyTest):
+
+	__tests__ = ["setup",
+		     "test_roundTrip",
+		     "test_truncated",
+		     "test_replayDefaultClients",
+		     "test_replayKind",
+		     "teardown",
+		     ]
+
+	def __init__(self, bus, path):
+		_PasyTest.__init__(self, "KeyLog", False)
+
+	def setup(self, test):
+		handle, self.filename = tempfile.mkstemp(".keylog")
+		os.close(handle)
+		os.remove(self.filename)
+		recorder = KeyRecorder(self.filename)
+		for event in events:
+			if recorder(event):
+				test.fail("Recorder consumed an event")
+		recorder.close()
+
+	def test_roundTrip(self, test):
+		reader = KeyLogReader(self.filename)
+		read = [fields(event) for event in reader]
+		reader.close()
+		if read != [fields(event) for event in events]:
+			test.fail("Events read back differ from the events recorded")
+
+	def test_truncated(self, test):
+		handle = open(self.filename, "ab")
+		handle.write(b"\x20\x00\x00\x00\x00\x61")
+		handle.close()
+		reader = KeyLogReader(self.filename)
+		count = len(list(reader))
+		reader.close()
+		test.assertEqual(count, len(events), "Truncated trailing record not dropped")
+
+	def test_replayDefaultClients(self, test):
+		# Nothing has registered a keystroke listener or set up the registry.
+		count = replayKeyLog(self.filename, speed=0)
+		test.assertEqual(count, len(events), "Not all events replayed without clients")
+
+	def test_replayKind(self, test):
+		received = []
+		def client(event):
+			received.append(int(event.type))
+			return False
+		keyFilter = _KeystrokeFilter(client)
+		keyFilter.add([], [0, 1, 4],
+			      pyatspi.Registry.makeKind((KEY_PRESSED_EVENT,)),
+			      pyatspi.Registry.makeSyncType(True, True, False))
+		count = replayKeyLog(self.filename, clients=[keyFilter], speed=0)
+		test.assertEqual(count, len(events), "Not all events replayed")
+		test.assertEqual(received, [int(KEY_PRESSED_EVENT)] * 3,
+				 "Replay not filtered by event kind")
+
+		received[:] = []
+		keyFilter = _KeystrokeFilter(client)
+		keyFilter.add([38], [0],
+			      pyatspi.Registry.makeKind((KEY_PRESSED_EVENT, KEY_RELEASED_EVENT)),
+			      pyatspi.Registry.makeSyncType(True, True, False))
+		replayKeyLog(self.filename, clients=[keyFilter], speed=0)
+		test.assertEqual(received, [int(KEY_PRESSED_EVENT), int(KEY_RELEASED_EVENT)],
+				 "Replay not filtered by key and modifiers")
+
+	def teardown(self, test):
+		os.remove(self.filename)
@@ -0,0 +1,97 @@
+from pasytest import PasyTest as _PasyTest
+
+import pyatspi
+from pyatspi.deviceevent import KEY_PRESSED_EVENT, KEY_RELEASED_EVENT
+
+from stubs import NativeRecorder
+
+def client(event):
+	return False
+
+class KeystrokeTest(_PasyTest):
+
+	__tests__ = ["setup",
+		     "test_mergedMasks",
+		     "test_syncTypes",
+		     "test_deregister",
+		     "teardown",
+		     ]
+
+	def __init__(self, bus, path):
+		_PasyTest.__init__(self, "Keystroke", False)
+
+	def setup(self, test):
+		self._registry = pyatspi.Registry()
+		self._recorder = NativeRecorder()
+		self._recorder.install()
+		self._press = self._registry.makeKind((KEY_PRESSED_EVENT,))
+		self._sync = self._registry.makeSyncType(True, True, False)
+		self._async = self._registry.makeSyncType(False, False, False)
+
+	def _check(self, test, expected, message):
+		calls = self._recorder.take()
+		test.assertEqual(sorted(calls), sorted(expected), "%s: %s, expected %s" % (message, calls, expected))
+
+	def test_mergedMasks(self, test):
+		registry = self._registry
+		press, sync = self._press, self._sync
+		registry.registerKeystrokeListener(client, [38], mask=[0, 4, 0x104], kind=(KEY_PRESSED_EVENT,))
+		# 0x104 has the same low eight bits as 4
+		self._check(test, [("register", 0, press, sync, (38,)),
+				   ("register", 4, press, sync, (38,))],
+			    "Masks not registered once each")
+
+		registry.registerKeystrokeListener(client, [38], mask=[0, 4], kind=(KEY_PRESSED_EVENT,))
+		self._check(test, [], "Registering the same masks again made native calls")
+
+		registry.registerKeystrokeListener(client, [39], mask=0, kind=(KEY_PRESSED_EVENT,))
+		self._check(test, [("deregister", 0, press),
+				   ("register", 0, press, sync, (38, 39))],
+			    "Key sets of a mask not merged")
+		test.assertEqual(len(self._recorder.listeners), 1, "Several native listeners for one client")
+		registry.deregisterKeystrokeListener(client, mask=[0, 4], kind=(KEY_PRESSED_EVENT,))
+		self._recorder.take()
+
+	def test_syncTypes(self, test):
+		registry = self._registry
+		press, sync, async_ = self._press, self._sync, self._async
+		registry.registerKeystrokeListener(client, [38], mask=0, kind=(KEY_PRESSED_EVENT,))
+		registry.registerKeystrokeListener(client, [50], mask=0, kind=(KEY_PRESSED_EVENT,),
+						   synchronous=False, preemptive=False)
+		self._check(test, [("register", 0, press, sync, (38,)),
+				   ("register", 0, press, async_, (50,))],
+			    "Sync types not registered separately")
+
+		# Deregistering the mask for the changed key set also drops the
+		# other sync type in the daemon, so it is registered again.
+		registry.registerKeystrokeListener(client, [39], mask=0, kind=(KEY_PRESSED_EVENT,))
+		self._check(test, [("deregister", 0, press),
+				   ("register", 0, press, sync, (38, 39)),
+				   ("register", 0, press, async_, (50,))],
+			    "Other sync type not registered again")
+		registry.deregisterKeystrokeListener(client, mask=0, kind=(KEY_PRESSED_EVENT,))
+		self._recorder.take()
+
+	def test_deregister(self, test):
+		registry = self._registry
+		press, sync, async_ = self._press, self._sync, self._async
+		both = registry.makeKind((KEY_PRESSED_EVENT, KEY_RELEASED_EVENT))
+		registry.registerKeystrokeListener(client, [38], mask=[0, 4], kind=(KEY_PRESSED_EVENT,))
+		registry.registerKeystrokeListener(client, [50], mask=0, kind=(KEY_PRESSED_EVENT,),
+						   synchronous=False, preemptive=False)
+		registry.registerKeystrokeListener(client, [], mask=1, kind=(KEY_PRESSED_EVENT, KEY_RELEASED_EVENT))
+		self._recorder.take()
+
+		registry.deregisterKeystrokeListener(client, mask=0, kind=(KEY_PRESSED_EVENT,))
+		self._check(test, [("deregister", 0, press)],
+			    "Mask not deregistered once for all its sync types")
+		registry.deregisterKeystrokeListener(client, mask=1, kind=(KEY_PRESSED_EVENT, KEY_RELEASED_EVENT))
+		self._check(test, [("deregister", 1, both)], "Kind of a mask not deregistered")
+		test.assertEqual(client in registry.keystroke_listeners, True, "Client dropped too early")
+		registry.deregisterKeystrokeListener(client, mask=4, kind=(KEY_PRESSED_EVENT,))
+		self._check(test, [("deregister", 4, press)], "Last mask not deregistered")
+		test.assertEqual(client in registry.keystroke_listeners, False,
+				 "Client kept without registrations")
+
+	def teardown(self, test):
+		self._recorder.uninstall()
@@ -22,4 +22,14 @@ run libaccessibleapp.so collectiontest AccessibleTest
 run libcomponentapp.so componenttest ComponentTest
 run librelationapp.so relationtest RelationTest
 run libaccessibleapp.so statetest StateTest
+run libaccessibleapp.so focustest FocusTest
+run libtextapp.so texttest TextTest
+run libtableapp.so tabletest TableTest
+run libnoopapp.so deviceeventtest DeviceEventTest
+run libnoopapp.so keylogtest KeyLogTest
+run libnoopapp.so keystroketest KeystrokeTest
+run libnoopapp.so keybindingstest KeyBindingsTest
+run libnoopapp.so eventtracetest EventTraceTest
+run libnoopapp.so inputtest InputTest
+run libnoopapp.so importtest ImportTest
 exit $ret
@@ -8,7 +8,7 @@ import os
 from pasytest import PasyTest as _PasyTest
 
 import pyatspi
-from pyatspi import StateSet
+from pyatspi import StateSet, StateMask
 
 os = [pyatspi.STATE_MULTISELECTABLE,
       pyatspi.STATE_PRESSED,
@@ -27,6 +27,9 @@ class StateTest(_PasyTest):
 		     "test_compare",
 		     "test_isEmpty",
 		     "test_getStates",
+		     "test_mask",
+		     "test_maskAlgebra",
+		     "test_stateNames",
 		     "teardown",
 		     ]
 
@@ -97,5 +100,39 @@ class StateTest(_PasyTest):
 		if not (cone.issubset(ctwo) and ctwo.issubset(cone)):
 			test.fail("States not reported correctly")
 
+	def test_mask(self, test):
+		state = StateSet(*os)
+		mask = state.getMask()
+		if mask != StateMask(*os):
+			test.fail("Mask does not hold the states of the state set")
+		if not mask.contains(pyatspi.STATE_PRESSED) or pyatspi.STATE_ACTIVE in mask:
+			test.fail("Mask membership not correct")
+		if not mask.toStateSet().equals(state):
+			test.fail("Mask not converted back to the same state set")
+
+	def test_maskAlgebra(self, test):
+		mask = StateMask(*os)
+		if not mask.containsAll((pyatspi.STATE_PRESSED, pyatspi.STATE_SHOWING)):
+			test.fail("containsAll misses contained states")
+		if mask.containsAll(pyatspi.MASK_SHOWING_VISIBLE):
+			test.fail("containsAll finds states not contained")
+		if not mask.containsAny(pyatspi.MASK_SHOWING_VISIBLE):
+			test.fail("containsAny misses a contained state")
+		both = mask & pyatspi.MASK_SHOWING_VISIBLE
+		if both != StateMask(pyatspi.STATE_SHOWING):
+			test.fail("Intersection not correct")
+		if (mask | pyatspi.MASK_SHOWING_VISIBLE) - mask != StateMask(pyatspi.STATE_VISIBLE):
+			test.fail("Union or difference not correct")
+		if set(mask.getStates()) != set(os) or len(mask) != len(os):
+			test.fail("Mask states not reported correctly")
+
+	def test_stateNames(self, test):
+		# The name table is written out; check it against the constants.
+		constants = dict((value, name[6:].lower().replace('_', ' '))
+				 for name, value in vars(pyatspi.state).items()
+				 if name.startswith('STATE_') and isinstance(value, pyatspi.StateType))
+		if constants != pyatspi.STATE_VALUE_TO_NAME:
+			test.fail("STATE_VALUE_TO_NAME does not match the STATE_ constants")
+
 	def teardown(self, test):
 		pass
@@ -0,0 +1,54 @@
+# Stand-ins shared by the tests that do not need the registry daemon.
+
+import pyatspi.registry
+
+class Event(object):
+	"""
+	An event with the attributes of pyatspi.Event, for the code that only
+	reads them.
+	"""
+	def __init__(self, type, source, detail1=0, detail2=0, any_data=None):
+		self.type = type
+		self.source = source
+		self.detail1 = detail1
+		self.detail2 = detail2
+		self.any_data = any_data
+
+class NativeRecorder(object):
+	"""
+	Records the native keystroke listener calls made through
+	Atspi.register_keystroke_listener and deregister_keystroke_listener
+	between install() and uninstall(), instead of sending them to the
+	registry daemon.
+	"""
+	def __init__(self):
+		self.calls = []
+		self.listeners = set()
+		self._native = None
+
+	def install(self):
+		Atspi = pyatspi.registry.Atspi
+		self._native = (Atspi.register_keystroke_listener, Atspi.deregister_keystroke_listener)
+		Atspi.register_keystroke_listener = self.register
+		Atspi.deregister_keystroke_listener = self.deregister
+
+	def uninstall(self):
+		Atspi = pyatspi.registry.Atspi
+		Atspi.register_keystroke_listener, Atspi.deregister_keystroke_listener = self._native
+
+	def register(self, listener, key_set, mask, kind, syncFlag):
+		self.listeners.add(id(listener))
+		self.calls.append(("register", mask, kind, syncFlag, tuple(key_set)))
+		return True
+
+	def deregister(self, listener, key_set, mask, kind):
+		self.listeners.add(id(listener))
+		# the daemon drops the registrations for the mask and kind,
+		# whatever the key set
+		self.calls.append(("deregister", mask, kind))
+		return True
+
+	def take(self):
+		calls = self.calls
+		self.calls = []
+		return calls
@@ -0,0 +1,124 @@
+import dbus
+from gi.repository import GObject
+import os.path
+
+from xml.dom import minidom
+import os
+
+from pasytest import PasyTest as _PasyTest
+
+import pyatspi
+
+# The test table has 1000 rows and 8 columns, and the cell at (2, 1) spans
+# 2 rows and 3 columns.
+table_rows = 1000
+table_columns = 8
+
+class TableTest(_PasyTest):
+
+	__tests__ = ["setup",
+		     "test_size",
+		     "test_getIndexAt",
+		     "test_extents",
+		     "test_getAccessibleAt",
+		     "test_headers",
+		     "test_rowSelection",
+		     "test_selectRowRange",
+		     "test_getGridSnapshot",
+		     "teardown",
+		     ]
+
+	def __init__(self, bus, path):
+		_PasyTest.__init__(self, "Table", False)
+		self._bus = bus
+		self._path = path
+
+	def setup(self, test):
+		self._registry = pyatspi.Registry()
+		self._desktop = self._registry.getDesktop(0)
+		self._root = pyatspi.findDescendant (self._desktop, lambda x: x.name == "atspi-test-main" and x.getRole() == pyatspi.ROLE_APPLICATION)
+
+	def test_size(self, test):
+		table = self._root.queryTable()
+		test.assertEqual(table.nRows, table_rows,
+				 "nRows expected %d, recieved %d" % (table_rows, table.nRows))
+		test.assertEqual(table.nColumns, table_columns,
+				 "nColumns expected %d, recieved %d" % (table_columns, table.nColumns))
+		count = self._root.childCount
+		expected = table_rows * table_columns - 5
+		test.assertEqual(count, expected,
+				 "childCount expected %d, recieved %d" % (expected, count))
+
+	def test_getIndexAt(self, test):
+		table = self._root.queryTable()
+		for row, column, expected in ((0, 0, 0),
+					      (2, 1, 17),
+					      (3, 3, 17),
+					      (2, 4, 18),
+					      (4, 0, 27)):
+			index = table.getIndexAt(row, column)
+			test.assertEqual(index, expected,
+					 "Index at (%d, %d) expected %d, recieved %d" % (row, column, expected, index))
+		test.assertEqual(table.getRowAtIndex(27), 4, "Wrong row at index 27")
+		test.assertEqual(table.getColumnAtIndex(18), 4, "Wrong column at index 18")
+
+	def test_extents(self, test):
+		table = self._root.queryTable()
+		test.assertEqual(table.getRowExtentAt(2, 1), 2, "Wrong row extent of a spanning cell")
+		test.assertEqual(table.getColumnExtentAt(3, 3), 3, "Wrong column extent of a spanning cell")
+		test.assertEqual(table.getColumnExtentAt(0, 0), 1, "Wrong column extent of a single cell")
+
+	def test_getAccessibleAt(self, test):
+		table = self._root.queryTable()
+		cell = table.getAccessibleAt(table_rows - 1, table_columns - 1)
+		expected = "Cell %d,%d" % (table_rows - 1, table_columns - 1)
+		test.assertEqual(cell.name, expected,
+				 "Cell name expected %s, recieved %s" % (expected, cell.name))
+		test.assertEqual(cell.getRole(), pyatspi.ROLE_TABLE_CELL, "Wrong cell role")
+
+	def test_headers(self, test):
+		table = self._root.queryTable()
+		test.assertEqual(table.getRowDescription(5), "Row No5", "Wrong row description")
+		test.assertEqual(table.getColumnHeader(3).name, "Column No3", "Wrong column header")
+		test.assertEqual(table.caption.name, "Default table caption", "Wrong caption")
+
+	def test_rowSelection(self, test):
+		table = self._root.queryTable()
+		table.addRowSelection(10)
+		table.addRowSelection(500)
+		selected = list(table.getSelectedRows())
+		test.assertEqual(selected, [10, 500],
+				 "Selected rows expected [10, 500], recieved %s" % selected)
+		test.assertEqual(table.isSelected(500, 3), True, "Cell of a selected row is not selected")
+		table.removeRowSelection(10)
+		table.removeRowSelection(500)
+		test.assertEqual(table.nSelectedRows, 0, "Rows were not deselected")
+
+	def test_selectRowRange(self, test):
+		table = self._root.queryTable()
+		test.assertEqual(table.selectRowRange(100, 110), True, "Rows were not selected")
+		selected = list(table.getSelectedRows())
+		test.assertEqual(selected, list(range(100, 110)),
+				 "Selected rows expected 100 to 109, recieved %s" % selected)
+		rows, columns = table.getSelectionBitmap()
+		test.assertEqual(rows[100 // 8], 0xf0, "Wrong selection bitmap")
+		test.assertEqual(rows[109 // 8], 0x3f, "Wrong selection bitmap")
+		test.assertEqual(table.deselectRowRange(0, table_rows), True, "Rows were not deselected")
+		test.assertEqual(table.nSelectedRows, 0, "Rows were not deselected")
+
+	def test_getGridSnapshot(self, test):
+		table = self._root.queryTable()
+		grid = table.getGridSnapshot(rows=(1, 4), columns=(0, 5), fields=('name',))
+		test.assertEqual(len(grid), 3, "Wrong number of rows in the snapshot")
+		test.assertEqual(grid[1][1] is grid[2][3], True, "Spanning cell is not shared")
+		test.assertEqual(grid[1][1].name, "Cell 2,1", "Wrong spanning cell")
+		test.assertEqual(grid[2][4].name, "Cell 3,4", "Wrong cell after the span")
+		grid = table.getGridSnapshot(rows=(0, table_rows), columns=(6, 8), fields=('name',))
+		test.assertEqual(len(grid), table_rows, "Wrong number of rows in a column strip")
+		for row in (0, 2, 3, table_rows - 1):
+			names = [cell.name for cell in grid[row]]
+			test.assertEqual(names, ["Cell %d,6" % row, "Cell %d,7" % row],
+					 "Wrong cells in row %d of a column strip" % row)
+
+	def teardown(self, test):
+		pass
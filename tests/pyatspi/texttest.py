@@ -0,0 +1,211 @@
+import dbus
+from gi.repository import GObject
+import os.path
+
+from xml.dom import minidom
+import os
+
+from pasytest import PasyTest as _PasyTest
+
+import pyatspi
+
+text_expected = "This is a test. It has two sentences!\nAnd a second line."
+
+# The "multibyte" child of the test application holds text with two and three
+# byte UTF-8 characters; offsets count characters, not bytes.
+multibyte_expected = u"na\u00efve caf\u00e9 \u65e5\u672c\u8a9e. Second sentence!"
+
+def unicode_text(value):
+	if isinstance(value, bytes):
+		return value.decode("utf-8")
+	return value
+
+class CountingText(object):
+	"""Counts the getTextAtOffset calls made through a Text interface."""
+	def __init__(self, text):
+		self._text = text
+		self.calls = 0
+
+	def __getattr__(self, name):
+		return getattr(self._text, name)
+
+	def getTextAtOffset(self, offset, type):
+		self.calls += 1
+		return self._text.getTextAtOffset(offset, type)
+
+class UnorderedText(object):
+	"""Keeps its selections in the order they were added, not by offset."""
+	def __init__(self, ranges):
+		self.ranges = list(ranges)
+
+	def getNSelections(self):
+		return len(self.ranges)
+
+	def getSelection(self, index):
+		return self.ranges[index]
+
+	def setSelection(self, index, start, end):
+		self.ranges[index] = (start, end)
+		return True
+
+	def addSelection(self, start, end):
+		self.ranges.append((start, end))
+		return True
+
+	def removeSelection(self, index):
+		del self.ranges[index]
+		return True
+
+class TextTest(_PasyTest):
+
+	__tests__ = ["setup",
+		     "test_characterCount",
+		     "test_getText",
+		     "test_addSelection",
+		     "test_TextSelections",
+		     "test_unorderedSelections",
+		     "test_multibyteText",
+		     "test_multibyteBoundaries",
+		     "test_iterTextUnits",
+		     "teardown",
+		     ]
+
+	def __init__(self, bus, path):
+		_PasyTest.__init__(self, "Text", False)
+		self._bus = bus
+		self._path = path
+
+	def setup(self, test):
+		self._registry = pyatspi.Registry()
+		self._desktop = self._registry.getDesktop(0)
+		self._root = pyatspi.findDescendant (self._desktop, lambda x: x.name == "atspi-test-main" and x.getRole() == pyatspi.ROLE_APPLICATION)
+
+	def test_characterCount(self, test):
+		text = self._root.queryText()
+		count = text.characterCount
+		test.assertEqual(count, len(text_expected),
+				 "characterCount expected %d, recieved %d" % (len(text_expected), count))
+
+	def test_getText(self, test):
+		text = self._root.queryText()
+		contents = text.getText(0, -1)
+		test.assertEqual(contents, text_expected,
+				 "Text expected %s, recieved %s" % (text_expected, contents))
+
+	def _multibyte(self):
+		return pyatspi.findDescendant(self._root, lambda x: x.name == "multibyte").queryText()
+
+	def test_multibyteText(self, test):
+		text = self._multibyte()
+		test.assertEqual(text.characterCount, len(multibyte_expected),
+				 "characterCount expected %d, recieved %d"
+				 % (len(multibyte_expected), text.characterCount))
+		for start, end in ((0, -1), (2, 9), (11, 14), (9, 12), (14, 22)):
+			contents = unicode_text(text.getText(start, end))
+			expected = multibyte_expected[start:] if end == -1 else multibyte_expected[start:end]
+			test.assertEqual(contents, expected,
+					 "Text %d-%d expected %r, recieved %r" % (start, end, expected, contents))
+
+	def test_multibyteBoundaries(self, test):
+		text = self._multibyte()
+		WORD_START = pyatspi.TEXT_BOUNDARY_WORD_START
+		WORD_END = pyatspi.TEXT_BOUNDARY_WORD_END
+		SENTENCE_START = pyatspi.TEXT_BOUNDARY_SENTENCE_START
+		for method, offset, type, start, end in (
+				(text.getTextAtOffset, 2, WORD_START, 0, 6),
+				(text.getTextAtOffset, 9, WORD_START, 6, 11),
+				(text.getTextAtOffset, 12, WORD_START, 11, 16),
+				(text.getTextAtOffset, 9, WORD_END, 5, 10),
+				(text.getTextAtOffset, 10, WORD_END, 10, 14),
+				(text.getTextAtOffset, 12, SENTENCE_START, 0, 15),
+				(text.getTextAtOffset, 20, SENTENCE_START, 15, 32),
+				(text.getTextAfterOffset, 2, WORD_START, 6, 11),
+				(text.getTextAfterOffset, 9, WORD_START, 11, 16),
+				(text.getTextAfterOffset, 9, WORD_END, 10, 14),
+				(text.getTextAfterOffset, 12, WORD_END, 14, 22),
+				(text.getTextAfterOffset, 9, SENTENCE_START, 15, 32),
+				(text.getTextBeforeOffset, 9, WORD_START, 0, 6),
+				(text.getTextBeforeOffset, 12, WORD_START, 6, 11),
+				(text.getTextBeforeOffset, 12, WORD_END, 5, 10),
+				(text.getTextBeforeOffset, 16, WORD_END, 10, 14),
+				(text.getTextBeforeOffset, 20, SENTENCE_START, 0, 15)):
+			unit = method(offset, type)
+			expected = (multibyte_expected[start:end], start, end)
+			received = (unicode_text(unit[0]), unit[1], unit[2])
+			test.assertEqual(received, expected,
+					 "%s(%d, %s) expected %r, recieved %r"
+					 % (method.__name__, offset, type, expected, received))
+
+	def test_addSelection(self, test):
+		text = self._root.queryText()
+		text.addSelection(5, 7)
+		test.assertEqual(text.getNSelections(), 1, "Selection was not added")
+		selection = text.getSelection(0)
+		test.assertEqual(selection, (5, 7),
+				 "Selection expected (5, 7), recieved (%d, %d)" % selection)
+		text.removeSelection(0)
+		test.assertEqual(text.getNSelections(), 0, "Selection was not removed")
+
+	def test_TextSelections(self, test):
+		text = self._root.queryText()
+		for expected in ([(0, 4), (10, 14), (19, 22)],
+				 [(2, 12), (13, 20)],
+				 [(0, 1), (3, 6), (16, 20), (30, 40)],
+				 []):
+			selections = pyatspi.TextSelections(text)
+			test.assertEqual(selections.apply(expected), True, "Selections were not applied")
+			selections = pyatspi.TextSelections(text)
+			test.assertEqual(list(selections), expected,
+					 "Selections expected %s, recieved %s" % (expected, list(selections)))
+
+	def test_unorderedSelections(self, test):
+		text = UnorderedText([(10, 14), (0, 4), (19, 22)])
+		selections = pyatspi.TextSelections(text)
+		test.assertEqual(list(selections), [(0, 4), (10, 14), (19, 22)],
+				 "Selections not sorted: %s" % (list(selections),))
+		expected = [(0, 4), (12, 16)]
+		test.assertEqual(selections.apply(expected), True, "Selections were not applied")
+		test.assertEqual(sorted(text.ranges), expected,
+				 "Selections of the object expected %s, recieved %s" % (expected, text.ranges))
+		test.assertEqual(list(selections), expected,
+				 "Snapshot expected %s, recieved %s" % (expected, list(selections)))
+
+	def test_iterTextUnits(self, test):
+		for text in (self._root.queryText(), self._multibyte()):
+			self._checkTextUnits(test, text)
+
+	def _checkTextUnits(self, test, text):
+		count = text.characterCount
+		for type in (pyatspi.TEXT_BOUNDARY_CHAR,
+			     pyatspi.TEXT_BOUNDARY_WORD_START,
+			     pyatspi.TEXT_BOUNDARY_WORD_END,
+			     pyatspi.TEXT_BOUNDARY_SENTENCE_START,
+			     pyatspi.TEXT_BOUNDARY_SENTENCE_END,
+			     pyatspi.TEXT_BOUNDARY_LINE_START,
+			     pyatspi.TEXT_BOUNDARY_LINE_END):
+			expected = []
+			offset = 0
+			while offset < count:
+				unit = text.getTextAtOffset(offset, type)
+				if unit[2] <= offset:
+					unit = text.getTextAfterOffset(offset, type)
+					if unit[2] <= offset:
+						break
+				expected.append(tuple(unit))
+				offset = unit[2]
+			# Small chunks, so that units cross chunk edges.
+			for localRules in (None, False, True):
+				counting = CountingText(text)
+				units = list(pyatspi.iterTextUnits(counting, type, chunkSize=16,
+								   localRules=localRules))
+				test.assertEqual(units, expected,
+						 "Units of type %s (local rules %s) differ from getTextAtOffset: %s, expected %s"
+						 % (type, localRules, units, expected))
+				if localRules is None and type in (pyatspi.TEXT_BOUNDARY_WORD_START,
+								   pyatspi.TEXT_BOUNDARY_WORD_END):
+					if counting.calls >= len(units):
+						test.fail("Words requested one by one by default: %d calls for %d units"
+							  % (counting.calls, len(units)))
+
+	def teardown(self, test):
+		pass